@@ -22,6 +22,7 @@ typedef struct { // List of all the tracks
 typedef struct {
     char id[64];
     char name[256];
+    char genres[512];  // First 5 genres, comma separated
     int followers;
     int popularity;
     char uri[128];
@@ -204,6 +205,13 @@ SpotifyTrackList* spotify_get_saved_tracks(SpotifyToken *token, int limit, int o
 SpotifyAlbumList* spotify_get_artist_albums(SpotifyToken *token, const char *artist_id);
 SpotifyPlaylistList* spotify_get_user_playlists(SpotifyToken *token, int limit, int offset);
 SpotifyPlayerState* spotify_get_player_state(SpotifyToken *token);
+bool spotify_fetch_player_state(SpotifyToken *token, SpotifyPlayerState *state, bool *active);
+
+// Fetch every page of a listing (remaining pages are fetched concurrently)
+SpotifyTrackList* spotify_get_all_saved_tracks(SpotifyToken *token);
+SpotifyTrackList* spotify_get_all_playlist_tracks(SpotifyToken *token, const char *playlist_id);
+SpotifyPlaylistList* spotify_get_all_user_playlists(SpotifyToken *token);
+SpotifyAlbumList* spotify_get_all_user_saved_albums(SpotifyToken *token);
 
 // Playlist management
 char* spotify_get_current_user_id(SpotifyToken *token);
@@ -257,6 +265,39 @@ void spotify_print_recommendations(SpotifyRecommendations *recommendations);
 void spotify_print_track(SpotifyTrack *track, int index);
 void spotify_print_user_profile(SpotifyUserProfile *profile);
 
+// Request layer statistics (see --stats)
+typedef struct {
+    long requests;              // Transfers sent
+    long cache_hits;            // Requests answered from the local cache
+    long throttled;             // 429 responses
+    long errors;                // Transport errors and 5xx responses
+    long avg_latency_ms;
+    long baseline_latency_ms;
+    double concurrency_window;  // Current adaptive limit for concurrent requests
+    int max_concurrency;
+    long long wire_bytes;       // Response bodies as received (compressed)
+    long long decoded_bytes;    // Response bodies after decompression
+} SpotifyRequestStats;
+
+void spotify_get_request_stats(SpotifyRequestStats *stats);
+void spotify_print_request_stats(void);
+
+// Clients: one per account, each with its own token, connections, stats and settings
+typedef struct SpotifyClient SpotifyClient;
+
+typedef struct {
+    const char *token_path;     // Token file, NULL for ~/.config/spotCLI/token.json
+    bool disable_cache;         // Never answer this client's requests from the response cache
+    int max_concurrency;        // Upper bound for concurrent requests, 0 for the default
+} SpotifyClientConfig;
+
+SpotifyClient* spotify_client_new(const SpotifyClientConfig *config);
+void spotify_client_free(SpotifyClient *client);
+SpotifyToken* spotify_client_token(SpotifyClient *client);
+bool spotify_token_keep_fresh(SpotifyToken *token);
+bool spotify_warm_connection(SpotifyClient *client);
+void spotify_client_get_stats(SpotifyClient *client, SpotifyRequestStats *stats);
+
 // Control playback (pause/resume/start/toggle)
 bool spotify_pause_playback(SpotifyToken *token, const char *device_id);
 bool spotify_resume_playback(SpotifyToken *token, const char *device_id);
@@ -12,6 +12,7 @@ typedef struct {
     char refresh_token[512];
     long expires_in;
     time_t obtained_at;
+    struct SpotifyClient *client;   // Owning client, NULL for the default one
 } SpotifyToken;
 
 bool spotify_is_authenticated();
@@ -20,6 +21,6 @@ bool spotify_refresh_token(SpotifyToken *token);
 bool spotify_load_token(SpotifyToken *token);
 bool spotify_save_token(SpotifyToken *token);
 bool spotify_get_access_token(SpotifyToken *token);
-char* get_token_path();
+bool get_token_path(const SpotifyToken *token, char *path, size_t size);
 
 #endif
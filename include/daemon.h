@@ -0,0 +1,19 @@
+#ifndef DAEMON_H
+#define DAEMON_H
+
+#include <stdbool.h>
+
+#define DAEMON_SOCKET_NAME "spotCLI.sock"
+#define DAEMON_MAX_REQUEST 8192     // Bytes of command line a client may send
+#define DAEMON_RECV_TIMEOUT_MS 2000 // Time a client has to send its command
+
+// Runs one command line in the daemon and returns its exit status
+typedef int (*DaemonCommandHandler)(int argc, char *argv[], void *userdata);
+
+// Serve commands on the daemon socket until SIGINT/SIGTERM, returns the exit status
+int daemon_serve(DaemonCommandHandler handler, void *userdata);
+
+// Run argv in a running daemon; false if none is listening (run the command directly)
+bool daemon_forward(int argc, char *argv[], int *status);
+
+#endif
@@ -101,6 +101,15 @@ SpotifyRecentlyPlayed* spotify_get_recently_played(SpotifyToken *token, int limi
  */
 SpotifyAlbumList* spotify_get_user_saved_albums(SpotifyToken *token, int limit, int offset);
 
+/**
+ * Get every saved album of the current user
+ * Reads total from the first page and fetches the remaining pages concurrently
+ * 
+ * @param token - Valid Spotify token
+ * @return SpotifyAlbumList with all saved albums, or NULL on error
+ */
+SpotifyAlbumList* spotify_get_all_user_saved_albums(SpotifyToken *token);
+
 /**
  * Remove albums from current user's 'Your Music' library
  * 
@@ -4,6 +4,7 @@
 #include "spotify/spotify_internal.h"
 
 SpotifyPlayerState* spotify_get_player_state(SpotifyToken *token);
+bool spotify_fetch_player_state(SpotifyToken *token, SpotifyPlayerState *state, bool *active);
 bool spotify_pause_playback(SpotifyToken *token, const char *device_id);
 bool spotify_resume_playback(SpotifyToken *token, const char *device_id);
 bool spotify_start_playback(SpotifyToken *token, const char *device_id, const char *context_uri, const char **uris, int uri_count);
@@ -42,6 +42,24 @@ bool spotify_seek_to_position(SpotifyToken *token, int position_ms, const char *
  */
 SpotifyTrackList* spotify_get_playlist_tracks(SpotifyToken *token, const char *playlist_id, int limit, int offset);
 
+/**
+ * Get every track of a playlist
+ * Reads total from the first page and fetches the remaining pages concurrently
+ * 
+ * @param token - Valid Spotify token
+ * @param playlist_id - Spotify playlist ID
+ * @return SpotifyTrackList with all tracks, or NULL on error
+ */
+SpotifyTrackList* spotify_get_all_playlist_tracks(SpotifyToken *token, const char *playlist_id);
+
+/**
+ * Get every playlist of the current user
+ * 
+ * @param token - Valid Spotify token
+ * @return SpotifyPlaylistList with all playlists, or NULL on error
+ */
+SpotifyPlaylistList* spotify_get_all_user_playlists(SpotifyToken *token);
+
 /**
  * Reorder or replace tracks in a playlist
  * Can be used to move tracks around or completely replace playlist contents
@@ -23,11 +23,12 @@
 SpotifyTrack* spotify_get_track(SpotifyToken *token, const char *track_id, const char *market);
 
 /**
- * Get detailed information about multiple tracks (max 50)
+ * Get detailed information about multiple tracks
+ * More than 50 IDs are split into chunks fetched concurrently
  * 
  * @param token - Valid Spotify token
  * @param track_ids - Array of Spotify track IDs
- * @param count - Number of track IDs (max 50)
+ * @param count - Number of track IDs
  * @param market - Optional: ISO 3166-1 alpha-2 country code (NULL for no market filter)
  * @return SpotifyTrackList or NULL on error
  * 
@@ -55,6 +56,15 @@ SpotifyTrackList* spotify_get_tracks(SpotifyToken *token, const char **track_ids
  */
 SpotifyTrackList* spotify_get_saved_tracks(SpotifyToken *token, int limit, int offset);
 
+/**
+ * Get every saved track of the current user
+ * Reads total from the first page and fetches the remaining pages concurrently
+ * 
+ * @param token - Valid Spotify token
+ * @return SpotifyTrackList with all saved tracks, or NULL on error
+ */
+SpotifyTrackList* spotify_get_all_saved_tracks(SpotifyToken *token);
+
 // ===== LIBRARY MANAGEMENT FUNCTIONS =====
 
 /**
@@ -0,0 +1,55 @@
+#ifndef SPOTIFY_ARENA_H
+#define SPOTIFY_ARENA_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+// ===== RESPONSE ARENAS =====
+
+/**
+ * Bump-allocated region for the structures built from API responses
+ *
+ * While an arena is active on a thread, list APIs (search results, playlist
+ * tracks, queue, recently played...) place their list header and arrays in
+ * it instead of calling malloc. The matching spotify_free_* calls become
+ * no-ops for that memory, and everything is released at once with
+ * spotify_arena_reset() or spotify_arena_free().
+ *
+ * Example:
+ *   SpotifyArena *arena = spotify_arena_new(0);
+ *   SpotifyArena *previous = spotify_arena_begin(arena);
+ *   SpotifyTrackList *results = spotify_search_tracks(token, "query", 10);
+ *   ...
+ *   spotify_arena_end(previous);
+ *   spotify_arena_reset(arena);    // results is gone
+ */
+typedef struct SpotifyArena SpotifyArena;
+
+/**
+ * Create an arena
+ *
+ * @param block_size - Size of each region (0 for the 64 KiB default)
+ * @return New arena or NULL on error (free with spotify_arena_free)
+ */
+SpotifyArena* spotify_arena_new(size_t block_size);
+
+/**
+ * Release everything allocated from the arena, keeping its first region for reuse
+ */
+void spotify_arena_reset(SpotifyArena *arena);
+void spotify_arena_free(SpotifyArena *arena);
+
+/**
+ * Make arena the allocation target of the calling thread
+ *
+ * @return The previously active arena (NULL if none), to pass to spotify_arena_end
+ */
+SpotifyArena* spotify_arena_begin(SpotifyArena *arena);
+void spotify_arena_end(SpotifyArena *previous);
+
+/**
+ * Bytes handed out since the last reset
+ */
+size_t spotify_arena_used(const SpotifyArena *arena);
+
+#endif
@@ -2,30 +2,419 @@
 #define SPOTIFY_INTERNAL_H
 
 #include "api.h"
+#include "spotify/api/endpoints.h"
 #include <json-c/json.h>
 #include <stdbool.h>
 #include <string.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <curl/curl.h>
 
 // PUBLIC INTERFACE (WHAT USERS CAN SEE)
 
-// ===== HTTP FUNCTIONS (spotify_http.c) =====
+// ===== REQUEST ENGINE (http.c) =====
+typedef enum {
+    SPOTIFY_METHOD_GET,
+    SPOTIFY_METHOD_PUT,
+    SPOTIFY_METHOD_POST,
+    SPOTIFY_METHOD_DELETE
+} SpotifyMethod;
+
+typedef enum {
+    SPOTIFY_SINK_NONE,      // Body is discarded
+    SPOTIFY_SINK_BUFFER,    // Body is kept in SpotifyResponse.body
+    SPOTIFY_SINK_JSON       // Body is parsed incrementally into SpotifyResponse.json as it arrives
+} SpotifyResponseSink;
+
+typedef enum {
+    SPOTIFY_RETRY_BY_METHOD,    // Transient failures are retried unless the method is POST
+    SPOTIFY_RETRY_NEVER,
+    SPOTIFY_RETRY_ALWAYS        // For POSTs the caller knows to be idempotent
+} SpotifyRetryPolicy;
+
+#define SPOTIFY_MAX_EXPECTED_STATUS 4
+#define SPOTIFY_DEFAULT_TIMEOUT_MS 30000
+#define SPOTIFY_CONNECT_TIMEOUT_MS 10000
+#define SPOTIFY_ETAG_SIZE 128
+
+typedef struct SpotifyCacheEntry SpotifyCacheEntry;
+
+// Description of one API call, shared by every HTTP verb
+typedef struct {
+    SpotifyMethod method;
+    const char *url;
+    const char *body;                                  // JSON body or NULL
+    long expected_status[SPOTIFY_MAX_EXPECTED_STATUS]; // Zero-terminated, empty accepts any status
+    SpotifyResponseSink sink;
+    SpotifyRetryPolicy retry;
+    bool bypass_cache;                                 // Always ask the server (consistency checks)
+    long timeout_ms;                                   // Deadline for the call including retries, 0 for the default
+    bool hedge;                                        // Send a second attempt if the first is unusually slow
+} SpotifyRequest;
+
+typedef struct {
+    long status;
+    CURLcode curl_code;
+    char *body;                 // Only filled by SPOTIFY_SINK_BUFFER
+    size_t body_size;           // Decoded bytes received, for every sink
+    struct json_object *json;
+    json_tokener *tokener;      // Incremental parser state while a JSON body streams in
+    bool parse_error;
+
+    // Caching headers of the response
+    char etag[SPOTIFY_ETAG_SIZE];
+    long max_age;               // Cache-Control max-age in seconds, 0 if absent
+    bool no_store;
+    SpotifyCacheEntry *cache_entry; // Stale entry being revalidated with If-None-Match
+
+    long retry_after;           // Retry-After in seconds on a 429, 0 if absent
+
+    SpotifyClient *client;      // Client the request was sent for, kept across resets
+    unsigned long long account; // Account of the token (spotify_cache_account), kept across resets
+} SpotifyResponse;
+
+/**
+ * Perform a request and fill response (release it with spotify_response_free)
+ * Returns true if the transfer succeeded with an expected status
+ */
+bool spotify_request_perform(SpotifyToken *token, const SpotifyRequest *request, SpotifyResponse *response);
+void spotify_response_free(SpotifyResponse *response);
+void spotify_response_reset(SpotifyResponse *response);
+const char* spotify_method_name(SpotifyMethod method);
+
+/**
+ * Lower-level halves of spotify_request_perform, for callers driving the handle themselves
+ */
+struct curl_slist* spotify_request_prepare(CURL *curl, SpotifyToken *token, const SpotifyRequest *request, SpotifyResponse *response);
+bool spotify_request_finish(CURL *curl, const SpotifyRequest *request, SpotifyResponse *response, CURLcode res);
+
+/**
+ * Deadlines are absolute spotify_monotonic_ms() times
+ * set_deadline bounds the transfer on curl and returns false if the deadline has passed
+ */
+long long spotify_request_deadline(const SpotifyRequest *request);
+bool spotify_request_set_deadline(CURL *curl, long long deadline);
+
+/**
+ * Requests without an explicit timeout_ms wait out rate-limit pauses on top
+ * of the default deadline; an explicit timeout is a hard bound
+ */
+bool spotify_request_waits_for_limit(const SpotifyRequest *request);
+
+// ===== RATE LIMITING (ratelimit.c) =====
+#define SPOTIFY_RATELIMIT_RATE 25           // Requests per second once the burst is spent
+#define SPOTIFY_RATELIMIT_BURST 50
+#define SPOTIFY_RATELIMIT_DEFAULT_PAUSE 5   // Seconds, when a 429 has no Retry-After
+#define SPOTIFY_RATELIMIT_MAX_WAIT_MS (2 * 60 * 1000)  // Longest pause a request waits out
+
+typedef enum {
+    SPOTIFY_CLASS_CATALOG,      // Tracks, albums, artists, search
+    SPOTIFY_CLASS_LIBRARY,      // /me library endpoints
+    SPOTIFY_CLASS_PLAYLIST,
+    SPOTIFY_CLASS_PLAYER,       // /me/player
+    SPOTIFY_CLASS_COUNT
+} SpotifyRequestClass;
+
+/**
+ * Shared token bucket plus a per-class pause set by 429 Retry-After
+ * reserve() returns 0 when a request may start, otherwise milliseconds to wait
+ */
+SpotifyRequestClass spotify_request_class(const SpotifyRequest *request);
+long spotify_ratelimit_reserve(SpotifyRequestClass cls);
+bool spotify_ratelimit_acquire(SpotifyRequestClass cls, long long *deadline, bool extend);
+void spotify_ratelimit_throttled(SpotifyRequestClass cls, long retry_after);
+long long spotify_monotonic_ms(void);
+void spotify_sleep_ms(long ms);
+
+// ===== RETRIES (retry.c) =====
+#define SPOTIFY_RETRY_MAX_ATTEMPTS 4        // Resends after the first attempt
+#define SPOTIFY_RETRY_BASE_MS 200
+#define SPOTIFY_RETRY_CAP_MS 5000
+
+/**
+ * Transient failures are resent after a jittered exponential backoff,
+ * non-idempotent requests only when their retry policy allows it
+ */
+bool spotify_retry_transient(const SpotifyResponse *response);
+long spotify_retry_backoff_ms(int attempt);
+long spotify_retry_delay(const SpotifyRequest *request, const SpotifyResponse *response, int attempt);
+
+// ===== HEDGED REQUESTS (hedge.c) =====
+#define SPOTIFY_HEDGE_SAMPLES 64
+#define SPOTIFY_HEDGE_DEFAULT_DELAY_MS 300  // Until enough latencies have been seen
+#define SPOTIFY_HEDGE_MIN_DELAY_MS 50
+
+/**
+ * Run a request with .hedge set: a second attempt is sent when the first has
+ * not answered within the p95 latency of recent hedged requests, and the
+ * first successful answer wins
+ */
+bool spotify_request_hedged(SpotifyToken *token, const SpotifyRequest *request, SpotifyResponse *response);
+long spotify_hedge_delay_ms(void);
+
+// ===== SINGLE-FLIGHT (singleflight.c) =====
+typedef struct SpotifyFlight SpotifyFlight;
+
+/**
+ * Concurrent identical GETs (same URL and token) share one transfer and one
+ * refcounted json_object; see spotify_request_perform()
+ */
+bool spotify_singleflight_join(const SpotifyToken *token, const SpotifyRequest *request,
+                               SpotifyResponse *response, bool *ok, SpotifyFlight **flight);
+void spotify_singleflight_end(SpotifyFlight *flight, const SpotifyResponse *response, bool ok);
+
+// ===== SESSION MEMO (session.c) =====
+#define SPOTIFY_SESSION_TTL_MS (5 * 60 * 1000)
+#define SPOTIFY_SESSION_MAX_PAGES 8
+#define SPOTIFY_SESSION_MAX_SNAPSHOTS 16
+
+/**
+ * Current user id and pages of the user's playlists, kept per account for the session
+ * Playlist mutations must call spotify_session_invalidate_playlists()
+ */
+bool spotify_session_user_id(const SpotifyToken *token, char *user_id, size_t size);
+void spotify_session_store_user_id(const SpotifyToken *token, const char *user_id);
+SpotifyPlaylistList* spotify_session_playlists(const SpotifyToken *token, int limit, int offset);
+void spotify_session_store_playlists(const SpotifyToken *token, int limit, int offset,
+                                     const SpotifyPlaylistList *list);
+void spotify_session_invalidate_playlists(const SpotifyToken *token);
+
+/**
+ * Last snapshot_id our own changes left a playlist at, so the next change
+ * has a baseline without a GET
+ */
+bool spotify_session_playlist_snapshot(const SpotifyToken *token, const char *playlist_id,
+                                       char *snapshot, size_t size);
+void spotify_session_store_playlist_snapshot(const SpotifyToken *token, const char *playlist_id,
+                                             const char *snapshot);
+
+typedef struct SpotifySession SpotifySession;
+SpotifySession* spotify_session_new(void);
+void spotify_session_free(SpotifySession *session);
+
+// ===== PLAYER MODEL (player_model.c) =====
+#define SPOTIFY_PLAYER_DRIFT_CHECK_MS (30 * 1000)
+
+typedef struct SpotifyPlayerModel SpotifyPlayerModel;
+
+/**
+ * Last /me/player state of an account, extrapolated with the monotonic clock
+ * get() misses at the predicted end of the track, after the drift check
+ * interval and after invalidate(), which every playback command must call
+ */
+SpotifyPlayerModel* spotify_player_model_new(void);
+void spotify_player_model_free(SpotifyPlayerModel *model);
+bool spotify_player_model_get(const SpotifyToken *token, SpotifyPlayerState *state);
+void spotify_player_model_store(const SpotifyToken *token, const SpotifyPlayerState *state,
+                                long long anchored_at);
+void spotify_player_model_invalidate(const SpotifyToken *token);
+bool spotify_player_state_extrapolate(SpotifyPlayerState *state, long long elapsed_ms);
+
+// ===== RESPONSE CACHE (cache.c) =====
+
+/**
+ * Persistent GET cache under ~/.config/spotCLI/cache, keyed by account+method+URL
+ * Honors Cache-Control max-age/no-store/private and revalidates stale entries with If-None-Match
+ */
+unsigned long long spotify_cache_account(const SpotifyToken *token);
+bool spotify_cache_lookup(const SpotifyRequest *request, SpotifyResponse *response);
+const char* spotify_cache_etag(const SpotifyResponse *response);
+bool spotify_cache_store(const SpotifyRequest *request, SpotifyResponse *response);
+void spotify_cache_entry_free(SpotifyCacheEntry *entry);
+void spotify_cache_set_enabled(bool enabled);
+bool spotify_config_subdir(const char *name, char *path, size_t size);
+
+// ===== PLAYLIST STORE (playlist_store.c) =====
+
+/**
+ * Full track sets of playlists kept under ~/.config/spotCLI/playlists with their snapshot_id
+ * load succeeds only when the stored snapshot matches; tracks is malloc'd
+ */
+bool spotify_playlist_store_load(const char *playlist_id, const char *snapshot_id,
+                                 SpotifyTrack **tracks, int *count);
+void spotify_playlist_store_save(const char *playlist_id, const char *snapshot_id,
+                                 const SpotifyTrack *tracks, int count);
+
+// ===== CONCURRENT REQUESTS (multi.c) =====
+#define SPOTIFY_BATCH_MAX_PARALLEL 16
+
+typedef void (*SpotifyBatchCallback)(int index, bool ok, SpotifyResponse *response, void *userdata);
+
+/**
+ * Perform count requests concurrently (HTTP/2 multiplexed when available)
+ * Fills responses[i] for every request; returns the number that succeeded
+ */
+int spotify_request_batch(SpotifyToken *token, const SpotifyRequest *requests, int count,
+                          SpotifyResponse *responses, bool *ok,
+                          SpotifyBatchCallback on_done, void *userdata);
+
+// ===== CONCURRENCY LIMITER (limiter.c) =====
+#define SPOTIFY_LIMITER_INITIAL_WINDOW 4
+#define SPOTIFY_LIMITER_SPIKE_FACTOR 3      // Latency over 3x the baseline...
+#define SPOTIFY_LIMITER_SPIKE_MIN_MS 250    // ...and at least this much above it is a spike
+#define SPOTIFY_STATS_MAX_ENDPOINTS 32
+
+typedef struct SpotifyLimiter SpotifyLimiter;
+
+/**
+ * AIMD window for spotify_request_batch(), fed by every finished transfer
+ * Also keeps the counters reported by spotify_get_request_stats()
+ */
+SpotifyLimiter* spotify_limiter_new(int max_window);
+void spotify_limiter_free(SpotifyLimiter *limiter);
+int spotify_limiter_window(SpotifyLimiter *limiter);
+void spotify_limiter_record(SpotifyLimiter *limiter, CURLcode res, long status, long latency_ms);
+void spotify_limiter_cache_hit(SpotifyLimiter *limiter);
+void spotify_limiter_record_bytes(SpotifyLimiter *limiter, const char *url,
+                                  long long wire_bytes, long long decoded_bytes);
+void spotify_limiter_stats(SpotifyLimiter *limiter, SpotifyRequestStats *stats);
+void spotify_limiter_print(SpotifyLimiter *limiter);
+
+// ===== FAST PARSER (fastparse.c) =====
+
+/**
+ * Build with -DSPOTIFY_FAST_PARSE (make FASTPARSE=1) to parse listing pages and
+ * player state straight from the raw body instead of through a json-c tree
+ */
+#ifdef SPOTIFY_FAST_PARSE
+#define SPOTIFY_LISTING_SINK SPOTIFY_SINK_BUFFER
+#else
+#define SPOTIFY_LISTING_SINK SPOTIFY_SINK_JSON
+#endif
+
+int fast_parse_track_items(const char *json, size_t len, const char *wrapper,
+                           SpotifyTrack **tracks, int *count);
+int fast_parse_playlist_items(const char *json, size_t len, SpotifyPlaylist **playlists, int *count);
+int fast_parse_artist_items(const char *json, size_t len, const char *array_key,
+                            SpotifyArtist **artists, int *count);
+bool fast_parse_player_state(const char *json, size_t len, SpotifyPlayerState *state);
+
+// ===== PAGINATION (paging.c) =====
+
+/**
+ * Fetch pages [start_offset, total) of an offset-paginated endpoint concurrently
+ * Returns page_count responses in offset order, or NULL if any page failed
+ * sink is SPOTIFY_SINK_JSON, or SPOTIFY_LISTING_SINK for pages read by the append helpers
+ */
+SpotifyResponse* spotify_fetch_pages(SpotifyToken *token, const char *url, int page_size,
+                                     int start_offset, int total, SpotifyResponseSink sink,
+                                     int *page_count);
+void spotify_free_pages(SpotifyResponse *pages, int page_count);
+struct json_object* spotify_page_items(SpotifyResponse *page);
+bool spotify_append_track_pages(SpotifyTrack **tracks, int *count, SpotifyResponse *pages,
+                                int page_count, const char *wrapper);
+bool spotify_append_playlist_pages(SpotifyPlaylist **playlists, int *count, SpotifyResponse *pages,
+                                   int page_count);
+
+// ===== HTTP FUNCTIONS (http.c) =====
 struct json_object* spotify_api_get(SpotifyToken *token, const char *url);
 bool spotify_api_put(SpotifyToken *token, const char *url, const char *json_data);
 bool spotify_api_put_empty(SpotifyToken *token, const char *url);
+struct json_object* spotify_api_put_json(SpotifyToken *token, const char *url, const char *json_data);
 bool spotify_api_post(SpotifyToken *token, const char *url, const char *json_data);
 bool spotify_api_post_empty(SpotifyToken *token, const char *url);
 struct json_object* spotify_api_post_json(SpotifyToken *token, const char *url, const char *json_data);
 struct json_object* spotify_api_delete_json(SpotifyToken *token, const char *url, const char *json_data);
 bool spotify_api_delete_empty(SpotifyToken *token, const char *url);
 
+// ===== ALLOCATION (arena.c) =====
+
+/**
+ * Allocation used for the structures returned by list APIs
+ * They go to the thread's active SpotifyArena when there is one (see spotify/arena.h)
+ * and must be released with spotify_mem_free(), which ignores arena memory
+ */
+void* spotify_mem_alloc(size_t size);
+void* spotify_mem_calloc(size_t count, size_t size);
+void* spotify_mem_realloc(void *ptr, size_t size);
+void spotify_mem_free(void *ptr);
+
+// ===== CONNECTION POOL (pool.c) =====
+#define SPOTIFY_POOL_SIZE SPOTIFY_BATCH_MAX_PARALLEL
+
+// ===== NETWORK CACHE (netcache.c) =====
+#define SPOTIFY_NETCACHE_DNS_TTL_S 300
+#define SPOTIFY_NETCACHE_MAX_HOSTS 8
+
+typedef struct SpotifyNetCache SpotifyNetCache;
+
+/**
+ * Addresses (and, with libcurl >= 8.12, TLS sessions) kept under
+ * ~/.config/spotCLI/net so one-shot invocations skip DNS and full handshakes
+ */
+SpotifyNetCache* spotify_netcache_load(void);
+void spotify_netcache_apply(SpotifyNetCache *cache, CURL *curl);
+void spotify_netcache_learn(SpotifyNetCache *cache, CURL *curl);
+void spotify_netcache_forget(SpotifyNetCache *cache);
+void spotify_netcache_save(SpotifyNetCache *cache, CURLSH *share);
+void spotify_netcache_free(SpotifyNetCache *cache);
+
+typedef struct SpotifyPool SpotifyPool;
+
+/**
+ * Reusable easy handles sharing one DNS/TLS session/connection cache
+ * Every request borrows a handle from its client's pool instead of calling curl_easy_init()
+ */
+SpotifyPool* spotify_pool_new(void);
+CURL* spotify_pool_acquire(SpotifyPool *pool);
+void spotify_pool_release(SpotifyPool *pool, CURL *curl);
+void spotify_pool_transfer_done(SpotifyPool *pool, CURL *curl, CURLcode res);
+CURLSH* spotify_pool_share(SpotifyPool *pool);
+void spotify_pool_free(SpotifyPool *pool);
+
+// ===== TOKEN REFRESH (refresh.c) =====
+#define SPOTIFY_TOKEN_REFRESH_MARGIN_S 300  // Refresh this long before the token expires
+#define SPOTIFY_TOKEN_RETRY_S 30            // Wait after a failed background refresh
+
+typedef struct SpotifyTokenRefresh SpotifyTokenRefresh;
+
+/**
+ * Refreshes of a client's token are single-flighted: a 401 on any number of
+ * concurrent requests causes one call to the token endpoint, and a token
+ * kept fresh in the background is replaced before it expires. Readers take
+ * the access token through spotify_token_bearer() so they never see a
+ * half-written one.
+ */
+SpotifyTokenRefresh* spotify_token_refresh_new(void);
+void spotify_token_refresh_stop(SpotifyTokenRefresh *refresh);
+void spotify_token_refresh_free(SpotifyTokenRefresh *refresh);
+void spotify_token_bearer(const SpotifyToken *token, char *access_token, size_t size);
+unsigned spotify_token_generation(const SpotifyToken *token);
+bool spotify_token_refresh(SpotifyToken *token, unsigned generation);
+
+// ===== CLIENT (client.c) =====
+
+/**
+ * Everything one account's requests share: its token, connection pool,
+ * concurrency limiter and stats, session memo, player model and configuration.
+ * Tokens that do not belong to a client created with spotify_client_new()
+ * (token->client == NULL) use the process-wide default client.
+ */
+struct SpotifyClient {
+    SpotifyToken token;
+    SpotifyPool *pool;
+    SpotifyLimiter *limiter;
+    SpotifySession *session;
+    SpotifyTokenRefresh *refresh;
+    SpotifyPlayerModel *player;
+    char token_path[512];       // Empty for ~/.config/spotCLI/token.json
+    bool cache_disabled;
+};
+
+SpotifyClient* spotify_default_client(void);
+SpotifyClient* spotify_token_client(const SpotifyToken *token);
+
 /**
  * URL-encodes a string for use in HTTP requests
  * Returns allocated string that must be freed by caller
  */
 char* url_encode(const char *str);
 
+/**
+ * Builds "<base>?ids=a,b,c" into url (truncated to size)
+ */
+void spotify_build_ids_url(char *url, size_t size, const char *base, const char **ids, int count);
+
 /**
  * Parse track, artist, playlist, device, player state data from JSON object into SpotifyTrack struct
  */
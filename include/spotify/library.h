@@ -7,6 +7,8 @@
 SpotifyTrackList* spotify_get_saved_tracks(SpotifyToken *token, int limit, int offset);
 bool spotify_save_tracks(SpotifyToken *token, const char **track_ids, int count);
 SpotifyPlaylistList* spotify_get_user_playlists(SpotifyToken *token, int limit, int offset);
+SpotifyTrackList* spotify_get_all_saved_tracks(SpotifyToken *token);
+SpotifyPlaylistList* spotify_get_all_user_playlists(SpotifyToken *token);
 
 #endif
 
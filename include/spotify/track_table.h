@@ -0,0 +1,92 @@
+#ifndef SPOTIFY_TRACK_TABLE_H
+#define SPOTIFY_TRACK_TABLE_H
+
+#include "api.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// ===== COMPACT TRACK STORAGE =====
+
+// Spotify IDs are 22 base62 characters
+#define SPOTIFY_TRACK_ID_SIZE 23
+
+// Offset of a NUL-terminated string in a SpotifyStringPool (0 is the empty string)
+typedef uint32_t SpotifyStrRef;
+
+/**
+ * Append-only string storage
+ * Interned strings are stored once and shared by every row that uses them
+ */
+typedef struct {
+    char *data;
+    size_t size;
+    size_t capacity;
+    SpotifyStrRef *slots;   // Open-addressing intern table, 0 = empty slot
+    size_t slot_count;
+    size_t interned;
+} SpotifyStringPool;
+
+/**
+ * Struct-of-arrays track storage
+ * A row costs ~40 bytes plus its unique strings instead of sizeof(SpotifyTrack),
+ * and artist/album names repeated across a library are stored once.
+ */
+typedef struct {
+    int count;
+    int capacity;
+    char (*ids)[SPOTIFY_TRACK_ID_SIZE];
+    int32_t *duration_ms;
+    SpotifyStrRef *names;
+    SpotifyStrRef *artists;     // Interned
+    SpotifyStrRef *albums;      // Interned
+    SpotifyStrRef *uris;        // 0 when the URI is "spotify:track:<id>"
+    SpotifyStringPool strings;
+} SpotifyTrackTable;
+
+/**
+ * Create an empty table
+ *
+ * @param capacity_hint - Expected number of tracks (0 if unknown)
+ * @return New table (free with spotify_track_table_free), or NULL on error
+ */
+SpotifyTrackTable* spotify_track_table_new(int capacity_hint);
+void spotify_track_table_free(SpotifyTrackTable *table);
+
+/**
+ * Append a track, copying its strings into the table
+ */
+bool spotify_track_table_append(SpotifyTrackTable *table, const SpotifyTrack *track);
+
+/**
+ * Build a table from / expand a table to the legacy SpotifyTrackList
+ */
+SpotifyTrackTable* spotify_track_table_from_list(const SpotifyTrackList *list);
+SpotifyTrackList* spotify_track_table_to_list(const SpotifyTrackTable *table);
+
+/**
+ * Expand one row into a legacy SpotifyTrack
+ */
+void spotify_track_table_get(const SpotifyTrackTable *table, int index, SpotifyTrack *track);
+
+// Row accessors, valid until the table is modified or freed
+const char* spotify_track_table_name(const SpotifyTrackTable *table, int index);
+const char* spotify_track_table_artist(const SpotifyTrackTable *table, int index);
+const char* spotify_track_table_album(const SpotifyTrackTable *table, int index);
+
+/**
+ * Bytes held by the table, for comparing against count * sizeof(SpotifyTrack)
+ */
+size_t spotify_track_table_memory(const SpotifyTrackTable *table);
+
+/**
+ * Get every saved track of the current user as a compact table
+ * Pages are converted as they are parsed, so the legacy structs for the whole
+ * library never exist at once
+ *
+ * @param token - Valid Spotify token
+ * @return SpotifyTrackTable or NULL on error
+ */
+SpotifyTrackTable* spotify_get_all_saved_tracks_table(SpotifyToken *token);
+
+#endif
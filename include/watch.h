@@ -0,0 +1,17 @@
+#ifndef WATCH_H
+#define WATCH_H
+
+#include "auth.h"
+
+#define WATCH_PLAYING_INTERVAL_MS 5000      // Poll rate while a track plays
+#define WATCH_PAUSED_INTERVAL_MS 15000      // ...while paused
+#define WATCH_IDLE_INTERVAL_MS 30000        // ...while no device is active
+#define WATCH_TRACK_END_SLACK_MS 500        // Past the predicted end before asking
+#define WATCH_MIN_INTERVAL_MS 1000
+#define WATCH_ERROR_BACKOFF_MS 2000         // First delay after a failed poll, doubled up to...
+#define WATCH_ERROR_BACKOFF_CAP_MS 60000
+
+// Poll the player and print changes as NDJSON on stdout until SIGINT/SIGTERM, returns the exit status
+int watch_player(SpotifyToken *token);
+
+#endif
@@ -1,13 +1,17 @@
 #include "auth.h"
 #include "dotenv.h"
+#include "spotify/spotify_internal.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <curl/curl.h>
 #include <json-c/json.h>
 #include <sys/stat.h>
+#include <sys/file.h>
+#include <fcntl.h>
 #include <unistd.h>
 #include <time.h>
+#include <pthread.h>
 
 // Forward declarations
 static size_t write_callback(void *ptr, size_t size, size_t nmemb, void *stream);
@@ -16,13 +20,13 @@ static bool spotify_token_is_expired(SpotifyToken *token);
 
 bool spotify_get_access_token(SpotifyToken *token) {
     if (!spotify_load_token(token)) {
-        printf("No token found, starting authorization...\n");
+        fprintf(stderr, "No token found, starting authorization...\n");
         return spotify_authorize(token);
     }
 
     // Check if token is expired
     if (spotify_token_is_expired(token)) {
-        printf("Token expired, refreshing...\n");
+        fprintf(stderr, "Token expired, refreshing...\n");
         return spotify_refresh_token(token);
     }
 
@@ -30,8 +34,8 @@ bool spotify_get_access_token(SpotifyToken *token) {
 }
 
 bool spotify_is_authenticated() {
-    char *token_path = get_token_path();
-    if (!token_path) return false;
+    char token_path[512];
+    if (!get_token_path(NULL, token_path, sizeof(token_path))) return false;
 
     FILE *f = fopen(token_path, "r");
     if (!f) return false;
@@ -39,21 +43,57 @@ bool spotify_is_authenticated() {
     return true;
 }
 
-bool spotify_load_token(SpotifyToken *token) {
-    char *token_path = get_token_path();
-    if (!token_path) return false;
+// Last token file read, reused while the file's inode and mtime are unchanged
+static struct {
+    char path[512];
+    dev_t dev;
+    ino_t ino;
+    struct timespec mtime;
+    SpotifyToken token;
+    bool valid;
+    pthread_mutex_t lock;
+} token_cache = { .lock = PTHREAD_MUTEX_INITIALIZER };
+
+static bool same_file(const struct stat *st, const char *path) {
+    return token_cache.valid && strcmp(token_cache.path, path) == 0 &&
+           token_cache.dev == st->st_dev && token_cache.ino == st->st_ino &&
+           token_cache.mtime.tv_sec == st->st_mtim.tv_sec &&
+           token_cache.mtime.tv_nsec == st->st_mtim.tv_nsec;
+}
 
-    FILE *f = fopen(token_path, "r");
-    if (!f) return false;
+// Copy the stored fields, leaving the owner (client) of dst alone
+static void copy_credentials(SpotifyToken *dst, const SpotifyToken *src) {
+    memcpy(dst->access_token, src->access_token, sizeof(dst->access_token));
+    memcpy(dst->refresh_token, src->refresh_token, sizeof(dst->refresh_token));
+    dst->expires_in = src->expires_in;
+    dst->obtained_at = src->obtained_at;
+}
+
+static bool parse_token_file(int fd, off_t size, SpotifyToken *token) {
+    char *data = malloc((size_t)size + 1);
+    if (!data) return false;
 
-    struct json_object *parsed = json_object_from_file(token_path);
-    if (!parsed) {
-        fclose(f);
+    size_t total = 0;
+    while (total < (size_t)size) {
+        ssize_t n = read(fd, data + total, (size_t)size - total);
+        if (n <= 0) break;
+        total += (size_t)n;
+    }
+    data[total] = '\0';
+
+    struct json_object *parsed = json_tokener_parse(data);
+    free(data);
+    if (!parsed) return false;
+
+    const char *access = json_object_get_string(json_object_object_get(parsed, "access_token"));
+    const char *refresh = json_object_get_string(json_object_object_get(parsed, "refresh_token"));
+    if (!access || !refresh) {
+        json_object_put(parsed);
         return false;
     }
 
-    strcpy(token->access_token, json_object_get_string(json_object_object_get(parsed, "access_token")));
-    strcpy(token->refresh_token, json_object_get_string(json_object_object_get(parsed, "refresh_token")));
+    snprintf(token->access_token, sizeof(token->access_token), "%s", access);
+    snprintf(token->refresh_token, sizeof(token->refresh_token), "%s", refresh);
     token->expires_in = json_object_get_int64(json_object_object_get(parsed, "expires_in"));
 
     // Load obtained_at if it exists, otherwise set to current time
@@ -66,21 +106,102 @@ bool spotify_load_token(SpotifyToken *token) {
     }
 
     json_object_put(parsed);
-    fclose(f);
     return true;
 }
 
-bool spotify_refresh_token(SpotifyToken *token) {
-    CURL *curl = curl_easy_init();
-    if (!curl) return false;
+/**
+ * Load the token file of token's client
+ * The file is only parsed again when it was replaced since the last load
+ */
+bool spotify_load_token(SpotifyToken *token) {
+    char token_path[512];
+    if (!get_token_path(token, token_path, sizeof(token_path))) return false;
+
+    int fd = open(token_path, O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        return false;
+    }
+
+    pthread_mutex_lock(&token_cache.lock);
+
+    bool ok = same_file(&st, token_path);
+    if (ok) {
+        copy_credentials(token, &token_cache.token);
+    } else if ((ok = parse_token_file(fd, st.st_size, token))) {
+        snprintf(token_cache.path, sizeof(token_cache.path), "%s", token_path);
+        token_cache.dev = st.st_dev;
+        token_cache.ino = st.st_ino;
+        token_cache.mtime = st.st_mtim;
+        copy_credentials(&token_cache.token, token);
+        token_cache.valid = true;
+    }
+
+    pthread_mutex_unlock(&token_cache.lock);
+    close(fd);
+    return ok;
+}
+
+/**
+ * Take the advisory lock that serializes token refreshes across processes
+ * Returns the descriptor to pass to unlock_token_file(), or -1 (then proceed unlocked)
+ */
+static int lock_token_file(const SpotifyToken *token) {
+    char lock_path[520];
+    if (!get_token_path(token, lock_path, sizeof(lock_path) - 5)) return -1;
+    strcat(lock_path, ".lock");
 
+    if (!token->client || !token->client->token_path[0]) ensure_token_dir();
+
+    int fd = open(lock_path, O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+    if (fd < 0) return -1;
+
+    if (flock(fd, LOCK_EX) != 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static void unlock_token_file(int fd) {
+    if (fd < 0) return;
+    flock(fd, LOCK_UN);
+    close(fd);
+}
+
+/**
+ * POST post_data to the token endpoint into response (4096 bytes)
+ * Uses a handle from the client's pool, so accounts.spotify.com gets the
+ * shared connections and the stored addresses and TLS sessions too
+ */
+static CURLcode post_token_request(const SpotifyToken *token, const char *post_data, char *response) {
+    SpotifyPool *pool = spotify_token_client(token)->pool;
+    CURL *curl = spotify_pool_acquire(pool);
+    if (!curl) return CURLE_FAILED_INIT;
+
+    curl_easy_setopt(curl, CURLOPT_URL, "https://accounts.spotify.com/api/token");
+    curl_easy_setopt(curl, CURLOPT_POSTFIELDS, post_data);
+    curl_easy_setopt(curl, CURLOPT_TIMEOUT_MS, (long)SPOTIFY_DEFAULT_TIMEOUT_MS);
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, write_callback);
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, response);
+
+    CURLcode res = curl_easy_perform(curl);
+    spotify_pool_transfer_done(pool, curl, res);
+    spotify_pool_release(pool, curl);
+
+    return res;
+}
+
+static bool request_refresh(SpotifyToken *token) {
     // Get credentials from environment
     const char *client_id = getenv("CLIENT_ID");
     const char *client_secret = getenv("CLIENT_SECRET");
 
     if (!client_id || !client_secret) {
         fprintf(stderr, "Error: CLIENT_ID or CLIENT_SECRET not set in environment\n");
-        curl_easy_cleanup(curl);
         return false;
     }
 
@@ -90,42 +211,96 @@ bool spotify_refresh_token(SpotifyToken *token) {
             token->refresh_token, client_id, client_secret);
 
     char response[4096] = {0};
+    if (post_token_request(token, post_data, response) != CURLE_OK) return false;
 
-    curl_easy_setopt(curl, CURLOPT_URL, "https://accounts.spotify.com/api/token");
-    curl_easy_setopt(curl, CURLOPT_POSTFIELDS, post_data);
-    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, write_callback);
-    curl_easy_setopt(curl, CURLOPT_WRITEDATA, response);
-
-    CURLcode res = curl_easy_perform(curl);
-    curl_easy_cleanup(curl);
-    if (res != CURLE_OK) return false;
-
+    // An error reply ("invalid_grant" for a revoked refresh token) has no access_token
     struct json_object *json = json_tokener_parse(response);
-    strcpy(token->access_token, json_object_get_string(json_object_object_get(json, "access_token")));
+    const char *access_token = json_object_get_string(json_object_object_get(json, "access_token"));
+    if (!access_token) {
+        fprintf(stderr, "Token refresh rejected: %s\n", response);
+        json_object_put(json);
+        return false;
+    }
+
+    snprintf(token->access_token, sizeof(token->access_token), "%s", access_token);
     token->expires_in = json_object_get_int64(json_object_object_get(json, "expires_in"));
     token->obtained_at = time(NULL);
+
+    // Spotify may rotate the refresh token
+    const char *refresh_token = json_object_get_string(json_object_object_get(json, "refresh_token"));
+    if (refresh_token) {
+        snprintf(token->refresh_token, sizeof(token->refresh_token), "%s", refresh_token);
+    }
     json_object_put(json);
 
-    spotify_save_token(token);
-    return true;
+    return spotify_save_token(token);
 }
 
-bool spotify_save_token(SpotifyToken *token) {
-    ensure_token_dir();
-    char *token_path = get_token_path();
-    if (!token_path) return false;
+/**
+ * Refresh the access token
+ *
+ * Refreshes are serialized across processes by an advisory lock on
+ * token.json.lock. Whoever gets the lock second finds the token the first
+ * one stored and uses it instead of calling the token endpoint again.
+ */
+bool spotify_refresh_token(SpotifyToken *token) {
+    int lock_fd = lock_token_file(token);
 
-    FILE *f = fopen(token_path, "w");
-    if (!f) return false;
+    SpotifyToken stored = *token;
+    bool replaced = spotify_load_token(&stored) &&
+                    strcmp(stored.access_token, token->access_token) != 0 &&
+                    time(NULL) < stored.obtained_at + stored.expires_in - SPOTIFY_TOKEN_REFRESH_MARGIN_S;
+
+    bool ok = true;
+    if (replaced) {
+        copy_credentials(token, &stored);
+    } else {
+        ok = request_refresh(token);
+    }
+
+    unlock_token_file(lock_fd);
+    return ok;
+}
+
+/**
+ * Store token atomically: write a temporary file next to token.json and
+ * rename it over the old one, so readers see either file but never a
+ * partial one
+ */
+bool spotify_save_token(SpotifyToken *token) {
+    char token_path[512];
+    if (!get_token_path(token, token_path, sizeof(token_path))) return false;
+    if (!token->client || !token->client->token_path[0]) ensure_token_dir();
 
     // Save current time as obtained_at if not set
     if (token->obtained_at == 0) {
         token->obtained_at = time(NULL);
     }
 
+    char tmp_path[540];
+    snprintf(tmp_path, sizeof(tmp_path), "%s.%ld.tmp", token_path, (long)getpid());
+
+    int fd = open(tmp_path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+    if (fd < 0) return false;
+
+    FILE *f = fdopen(fd, "w");
+    if (!f) {
+        close(fd);
+        unlink(tmp_path);
+        return false;
+    }
+
     fprintf(f, "{ \"access_token\": \"%s\", \"refresh_token\": \"%s\", \"expires_in\": %ld, \"obtained_at\": %ld }",
             token->access_token, token->refresh_token, token->expires_in, token->obtained_at);
-    fclose(f);
+
+    bool ok = fflush(f) == 0 && fsync(fd) == 0;
+    ok = fclose(f) == 0 && ok;
+    if (!ok || rename(tmp_path, token_path) != 0) {
+        fprintf(stderr, "Failed to save token to %s\n", token_path);
+        unlink(tmp_path);
+        return false;
+    }
+
     return true;
 }
 
@@ -134,7 +309,7 @@ static bool spotify_token_is_expired(SpotifyToken *token) {
     // If obtained_at is not set (0 or invalid), consider token valid
     // This prevents segfault when obtained_at is uninitialized
     if (token->obtained_at <= 0) {
-        printf("Token obtained_at not set, assuming valid\n");
+        fprintf(stderr, "Token obtained_at not set, assuming valid\n");
         return false;
     }
 
@@ -143,23 +318,27 @@ static bool spotify_token_is_expired(SpotifyToken *token) {
     time_t remaining = token->expires_in - elapsed;
 
     // Refresh if less than 5 minutes remaining
-    printf("Checking if token expired: elapsed=%ld, remaining=%ld\n", elapsed, remaining);
+    fprintf(stderr, "Checking if token expired: elapsed=%ld, remaining=%ld\n", elapsed, remaining);
 
-    bool is_expired = (now - token->obtained_at) >= (token->expires_in - 300);
-    printf("Token expired: %s\n", is_expired ? "yes" : "no");
+    bool is_expired = (now - token->obtained_at) >= (token->expires_in - SPOTIFY_TOKEN_REFRESH_MARGIN_S);
+    fprintf(stderr, "Token expired: %s\n", is_expired ? "yes" : "no");
 
     return is_expired;
 }
 
-// Get full path to token file
-char* get_token_path() {
-    static char path[512];
+// Get full path to the token file of token's client (NULL token: default client)
+bool get_token_path(const SpotifyToken *token, char *path, size_t size) {
+    if (token && token->client && token->client->token_path[0]) {
+        snprintf(path, size, "%s", token->client->token_path);
+        return true;
+    }
+
     const char *home = getenv("HOME");
     if (!home) home = getenv("USERPROFILE"); // Windows fallback
-    if (!home) return NULL;
+    if (!home) return false;
 
-    snprintf(path, sizeof(path), "%s/%s/%s", home, TOKEN_DIR, TOKEN_FILENAME);
-    return path;
+    snprintf(path, size, "%s/%s/%s", home, TOKEN_DIR, TOKEN_FILENAME);
+    return true;
 }
 
 bool spotify_authorize(SpotifyToken *token) {
@@ -185,9 +364,9 @@ bool spotify_authorize(SpotifyToken *token) {
         return false;
     }
 
-    printf("Open this URL in your browser to authorize spotCLI:\n");
-    printf("https://accounts.spotify.com/authorize?client_id=%s&response_type=code&redirect_uri=%s"
-            "&scope=%s\n\n", client_id, redirect_uri, user_scopes);
+    fprintf(stderr, "Open this URL in your browser to authorize spotCLI:\n");
+    fprintf(stderr, "https://accounts.spotify.com/authorize?client_id=%s&response_type=code&redirect_uri=%s"
+                    "&scope=%s\n\n", client_id, redirect_uri, user_scopes);
 
     char auth_code[512];
     char *start_callback_server(int port, char *code_buffer, size_t buffer_size);
@@ -196,10 +375,7 @@ bool spotify_authorize(SpotifyToken *token) {
         return false;
     }
 
-    printf("✓ Authorization code received: %s\n\n", auth_code);
-
-    CURL *curl = curl_easy_init();
-    if (!curl) return false;
+    fprintf(stderr, "✓ Authorization code received: %s\n\n", auth_code);
 
     char post_data[1024];
     sprintf(post_data,
@@ -207,15 +383,7 @@ bool spotify_authorize(SpotifyToken *token) {
             auth_code, redirect_uri, client_id, client_secret);
 
     char response[4096] = {0};
-    curl_easy_setopt(curl, CURLOPT_URL, "https://accounts.spotify.com/api/token");
-    curl_easy_setopt(curl, CURLOPT_POSTFIELDS, post_data);
-    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, write_callback);
-    curl_easy_setopt(curl, CURLOPT_WRITEDATA, response);
-
-    CURLcode res = curl_easy_perform(curl);
-    curl_easy_cleanup(curl);
-
-    if (res != CURLE_OK) return false;
+    if (post_token_request(token, post_data, response) != CURLE_OK) return false;
 
     struct json_object *json = json_tokener_parse(response);
     if (!json) {
@@ -242,7 +410,7 @@ bool spotify_authorize(SpotifyToken *token) {
     json_object_put(json);
 
     spotify_save_token(token);
-    printf("✅ Authorization successful! Tokens saved.\n");
+    fprintf(stderr, "✅ Authorization successful! Tokens saved.\n");
     return true;
 }
 
@@ -38,8 +38,8 @@ char* start_callback_server(int port, char *code_buffer, size_t buffer_size) {
         return NULL;
     }
 
-    printf("✓ Callback server listening on http://127.0.0.1:%d\n", port);
-    printf("Waiting for authorization...\n\n");
+    fprintf(stderr, "✓ Callback server listening on http://127.0.0.1:%d\n", port);
+    fprintf(stderr, "Waiting for authorization...\n\n");
 
     if ((client_fd = accept(server_fd, (struct sockaddr *)&address, (socklen_t*)&addrlen)) < 0) {
         perror("accept failed");
@@ -0,0 +1,407 @@
+// struct ucred (SO_PEERCRED)
+#define _GNU_SOURCE
+
+#include "daemon.h"
+#include "auth.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+
+/**
+ * Daemon mode: one long-lived process keeps the token, the connection pool
+ * and the caches warm, and runs commands sent by thin clients over a Unix
+ * domain socket.
+ *
+ * A client sends its stdin, stdout and stderr descriptors (SCM_RIGHTS)
+ * together with its command line, framed as a 32-bit length followed by
+ * the NUL-separated arguments. The daemon runs the command with those
+ * descriptors as its standard streams, so output and prompts reach the
+ * client's terminal directly, then answers with the 32-bit exit status.
+ * Commands run one at a time. Only processes of the daemon's own user are
+ * served, a client has DAEMON_RECV_TIMEOUT_MS to send its command, and a
+ * client that goes away (Ctrl-C at a prompt) cuts its command short.
+ */
+
+static volatile sig_atomic_t stop_requested = 0;
+static bool serving = false;
+
+static void handle_stop(int sig) {
+    (void)sig;
+    stop_requested = 1;
+}
+
+// Only there to interrupt a blocking read of a command whose client is gone
+static void handle_interrupt(int sig) {
+    (void)sig;
+}
+
+// $XDG_RUNTIME_DIR/spotCLI.sock, or ~/.config/spotCLI/spotCLI.sock
+static bool socket_path(struct sockaddr_un *addr) {
+    memset(addr, 0, sizeof(*addr));
+    addr->sun_family = AF_UNIX;
+
+    const char *runtime = getenv("XDG_RUNTIME_DIR");
+    const char *home = getenv("HOME");
+    int n;
+    if (runtime && runtime[0]) {
+        n = snprintf(addr->sun_path, sizeof(addr->sun_path), "%s/%s", runtime, DAEMON_SOCKET_NAME);
+    } else if (home) {
+        n = snprintf(addr->sun_path, sizeof(addr->sun_path), "%s/%s/%s", home, TOKEN_DIR, DAEMON_SOCKET_NAME);
+    } else {
+        return false;
+    }
+
+    return n > 0 && (size_t)n < sizeof(addr->sun_path);
+}
+
+static int connect_daemon(const struct sockaddr_un *addr) {
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) return -1;
+
+    if (connect(fd, (const struct sockaddr *)addr, sizeof(*addr)) != 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static bool write_all(int fd, const void *data, size_t size) {
+    const char *p = data;
+    while (size > 0) {
+        ssize_t n = write(fd, p, size);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        p += n;
+        size -= (size_t)n;
+    }
+    return true;
+}
+
+static bool read_all(int fd, void *data, size_t size) {
+    char *p = data;
+    while (size > 0) {
+        ssize_t n = read(fd, p, size);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        p += n;
+        size -= (size_t)n;
+    }
+    return true;
+}
+
+// ===== CLIENT =====
+
+bool daemon_forward(int argc, char *argv[], int *status) {
+    if (getenv("SPOTCLI_NO_DAEMON")) return false;
+
+    struct sockaddr_un addr;
+    if (!socket_path(&addr)) return false;
+
+    int fd = connect_daemon(&addr);
+    if (fd < 0) return false;
+
+    // Length prefix, then the arguments NUL-separated
+    char request[DAEMON_MAX_REQUEST];
+    size_t len = sizeof(uint32_t);
+    for (int i = 0; i < argc; i++) {
+        size_t arg_len = strlen(argv[i]) + 1;
+        if (len + arg_len > sizeof(request)) {
+            close(fd);
+            return false;
+        }
+        memcpy(request + len, argv[i], arg_len);
+        len += arg_len;
+    }
+    uint32_t body_len = (uint32_t)(len - sizeof(uint32_t));
+    memcpy(request, &body_len, sizeof(body_len));
+
+    int fds[3] = { STDIN_FILENO, STDOUT_FILENO, STDERR_FILENO };
+    char control[CMSG_SPACE(sizeof(fds))];
+    memset(control, 0, sizeof(control));
+
+    struct iovec iov = { .iov_base = request, .iov_len = len };
+    struct msghdr msg = {0};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+
+    struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(fds));
+    memcpy(CMSG_DATA(cmsg), fds, sizeof(fds));
+
+    ssize_t sent = sendmsg(fd, &msg, MSG_NOSIGNAL);
+    if (sent < 0) {
+        close(fd);
+        return false;
+    }
+    if ((size_t)sent < len && !write_all(fd, request + sent, len - (size_t)sent)) {
+        close(fd);
+        return false;
+    }
+
+    // From here on the command belongs to the daemon; a lost answer is a failure
+    int32_t result;
+    if (read_all(fd, &result, sizeof(result))) {
+        *status = result;
+    } else {
+        fprintf(stderr, "spotCLI daemon closed the connection\n");
+        *status = 1;
+    }
+
+    close(fd);
+    return true;
+}
+
+// ===== SERVER =====
+
+/**
+ * Receive one command: fills fds with the client's standard streams and
+ * argv with pointers into buffer. Returns argc, or -1 on a malformed request.
+ */
+static int receive_command(int conn, int fds[3], char *buffer, size_t size, char **argv, int max_args) {
+    char control[CMSG_SPACE(sizeof(int) * 3)];
+    uint32_t body_len = 0;
+
+    struct iovec iov = { .iov_base = &body_len, .iov_len = sizeof(body_len) };
+    struct msghdr msg = {0};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+
+    fds[0] = fds[1] = fds[2] = -1;
+    ssize_t n = recvmsg(conn, &msg, 0);
+    if (n <= 0) return -1;
+
+    for (struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+        if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS &&
+            cmsg->cmsg_len == CMSG_LEN(sizeof(int) * 3)) {
+            memcpy(fds, CMSG_DATA(cmsg), sizeof(int) * 3);
+        }
+    }
+    if (fds[0] < 0) return -1;
+
+    bool ok = (size_t)n == sizeof(body_len) ||
+              read_all(conn, (char *)&body_len + n, sizeof(body_len) - (size_t)n);
+    ok = ok && body_len > 0 && body_len < size && read_all(conn, buffer, body_len);
+    if (!ok) {
+        for (int i = 0; i < 3; i++) close(fds[i]);
+        return -1;
+    }
+    buffer[body_len - 1] = '\0';
+
+    int argc = 0;
+    for (size_t pos = 0; pos < body_len && argc < max_args; pos += strlen(buffer + pos) + 1) {
+        argv[argc++] = buffer + pos;
+    }
+    argv[argc] = NULL;
+
+    return argc;
+}
+
+// Peers must run as the daemon's user: commands act with its token
+static bool peer_allowed(int conn) {
+    struct ucred cred;
+    socklen_t len = sizeof(cred);
+    if (getsockopt(conn, SOL_SOCKET, SO_PEERCRED, &cred, &len) != 0) return false;
+    return cred.uid == geteuid();
+}
+
+// Watches the client while its command runs
+typedef struct {
+    int conn;
+    int wake[2];                // Written when the command is done
+    pthread_t command_thread;
+} ClientWatch;
+
+/**
+ * The client sends nothing after its command, so anything readable on the
+ * connection (normally EOF) means it is gone. Its streams are then replaced
+ * with /dev/null and the command thread is interrupted, so a prompt waiting
+ * on the dead client's terminal returns instead of blocking the daemon.
+ */
+static void* watch_client(void *arg) {
+    ClientWatch *watch = arg;
+    struct pollfd fds[2] = {
+        { .fd = watch->conn, .events = POLLIN },
+        { .fd = watch->wake[0], .events = POLLIN }
+    };
+
+    while (poll(fds, 2, -1) < 0) {
+        if (errno != EINTR) return NULL;
+    }
+    if (fds[1].revents) return NULL;
+
+    int devnull = open("/dev/null", O_RDWR);
+    if (devnull >= 0) {
+        for (int i = 0; i < 3; i++) {
+            dup2(devnull, i);
+        }
+        close(devnull);
+    }
+    pthread_kill(watch->command_thread, SIGUSR1);
+    return NULL;
+}
+
+static int run_command(int conn, DaemonCommandHandler handler, void *userdata, const int saved[3]) {
+    int fds[3];
+    char buffer[DAEMON_MAX_REQUEST];
+    char *argv[256];
+
+    if (!peer_allowed(conn)) {
+        fprintf(stderr, "Rejected a daemon client running as another user\n");
+        return -1;
+    }
+
+    // A client that connects but never sends must not hold up the others
+    struct timeval timeout = {
+        .tv_sec = DAEMON_RECV_TIMEOUT_MS / 1000,
+        .tv_usec = (DAEMON_RECV_TIMEOUT_MS % 1000) * 1000
+    };
+    setsockopt(conn, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+    int argc = receive_command(conn, fds, buffer, sizeof(buffer), argv, 255);
+    if (argc <= 0) return -1;
+
+    // The command's standard streams are the client's for its duration
+    fflush(stdout);
+    fflush(stderr);
+    for (int i = 0; i < 3; i++) {
+        dup2(fds[i], i);
+        close(fds[i]);
+    }
+
+    ClientWatch watch = { .conn = conn, .command_thread = pthread_self() };
+    pthread_t watcher;
+    bool watching = pipe(watch.wake) == 0;
+    if (watching && pthread_create(&watcher, NULL, watch_client, &watch) != 0) {
+        close(watch.wake[0]);
+        close(watch.wake[1]);
+        watching = false;
+    }
+
+    int status = handler(argc, argv, userdata);
+
+    // The watcher must be done with the standard streams before they are restored
+    if (watching) {
+        char done = 1;
+        ssize_t written = write(watch.wake[1], &done, 1);
+        (void)written;
+        pthread_join(watcher, NULL);
+        close(watch.wake[0]);
+        close(watch.wake[1]);
+    }
+
+    fflush(stdout);
+    fflush(stderr);
+    clearerr(stdin);
+    clearerr(stdout);
+    clearerr(stderr);
+    for (int i = 0; i < 3; i++) {
+        dup2(saved[i], i);
+    }
+
+    return status;
+}
+
+int daemon_serve(DaemonCommandHandler handler, void *userdata) {
+    if (serving) {
+        fprintf(stderr, "Already running as a daemon\n");
+        return 1;
+    }
+
+    struct sockaddr_un addr;
+    if (!socket_path(&addr)) {
+        fprintf(stderr, "No place for the daemon socket (set XDG_RUNTIME_DIR or HOME)\n");
+        return 1;
+    }
+
+    // A socket file nobody answers on is left over from a crashed daemon
+    int existing = connect_daemon(&addr);
+    if (existing >= 0) {
+        close(existing);
+        fprintf(stderr, "A spotCLI daemon is already listening on %s\n", addr.sun_path);
+        return 1;
+    }
+    unlink(addr.sun_path);
+
+    int server = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (server < 0) {
+        perror("socket failed");
+        return 1;
+    }
+
+    mode_t old_mask = umask(0077);
+    int bound = bind(server, (struct sockaddr *)&addr, sizeof(addr));
+    umask(old_mask);
+    if (bound < 0 || listen(server, 16) < 0) {
+        perror("bind failed");
+        close(server);
+        return 1;
+    }
+
+    // No SA_RESTART: a signal interrupts accept() so the loop can stop
+    struct sigaction stop = {0};
+    stop.sa_handler = handle_stop;
+    sigemptyset(&stop.sa_mask);
+    sigaction(SIGINT, &stop, NULL);
+    sigaction(SIGTERM, &stop, NULL);
+    signal(SIGPIPE, SIG_IGN);
+
+    struct sigaction interrupt = {0};
+    interrupt.sa_handler = handle_interrupt;
+    sigemptyset(&interrupt.sa_mask);
+    sigaction(SIGUSR1, &interrupt, NULL);
+
+    // Unbuffered, so input typed for one command never leaks into the next
+    setvbuf(stdin, NULL, _IONBF, 0);
+
+    int saved[3];
+    for (int i = 0; i < 3; i++) {
+        saved[i] = dup(i);
+    }
+
+    serving = true;
+    printf("spotCLI daemon listening on %s\n", addr.sun_path);
+    fflush(stdout);
+
+    while (!stop_requested) {
+        int conn = accept(server, NULL, NULL);
+        if (conn < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) continue;
+            perror("accept failed");
+            break;
+        }
+
+        int status = run_command(conn, handler, userdata, saved);
+        if (status >= 0) {
+            int32_t result = status;
+            write_all(conn, &result, sizeof(result));
+        }
+        close(conn);
+    }
+
+    serving = false;
+    close(server);
+    unlink(addr.sun_path);
+    for (int i = 0; i < 3; i++) {
+        close(saved[i]);
+    }
+
+    printf("spotCLI daemon stopped\n");
+    return 0;
+}
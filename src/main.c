@@ -1,10 +1,16 @@
 #include "auth.h"
 #include "api.h"
 #include "dotenv.h"
+#include "daemon.h"
+#include "watch.h"
+#include "spotify/arena.h"
+#include "spotify/track_table.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <getopt.h>
+#include <pthread.h>
+#include <time.h>
 
 void add_track_to_playlist_interactive(SpotifyToken *token);
 void create_playlist_interactive(SpotifyToken *token);
@@ -80,11 +86,16 @@ void print_usage(const char *prog_name) {
     printf("  -b, --audiobook   Search for audiobooks\n");
     printf("  -l, --list        List your saved tracks\n");
     printf("  -i, --interactive Interactive mode (menu)\n");
+    printf("  -s, --stats       Print request statistics on exit\n");
+    printf("      --daemon      Keep running and serve commands from other spotCLI invocations\n");
+    printf("      --watch       Print player changes as JSON lines until interrupted\n");
+    printf("      --startup-trace  Print how long each startup phase took\n");
     printf("  -h, --help        Show this help message\n\n");
     printf("Examples:\n");
     printf("  %s -t \"PTSMR\"\n", prog_name);
     printf("  %s --artist \"tyler, the creator\"\n", prog_name);
     printf("  %s --list\n", prog_name);
+    printf("  %s --watch\n", prog_name);
     printf("  %s --interactive\n\n", prog_name);
 }
 
@@ -472,23 +483,25 @@ void search_and_save(SpotifyToken *token, const char *query) {
 void view_saved_tracks(SpotifyToken *token) {
     printf("\nFetching your saved tracks...\n");
 
-    SpotifyTrackList *saved = spotify_get_saved_tracks(token, 20, 0);
+    // The whole library, kept compact: artist and album names are stored once
+    SpotifyTrackTable *saved = spotify_get_all_saved_tracks_table(token);
 
     if (!saved || saved->count == 0) {
         printf("No saved tracks found.\n");
-        if (saved) spotify_free_track_list(saved);
+        spotify_track_table_free(saved);
         return;
     }
 
-    printf("\nYou have %d saved tracks (showing first %d)\n\n", 
-            saved->total, saved->count);
+    printf("\nYou have %d saved tracks\n\n", saved->count);
 
     for (int i = 0; i < saved->count; i++) {
-        spotify_print_track(&saved->tracks[i], i + 1);
+        SpotifyTrack track;
+        spotify_track_table_get(saved, i, &track);
+        spotify_print_track(&track, i + 1);
         printf("\n");
     }
 
-    spotify_free_track_list(saved);
+    spotify_track_table_free(saved);
 }
 
 void view_users_playlists(SpotifyToken *token, int limit, int offset) {
@@ -524,6 +537,9 @@ void users_options() {
 }
 
 void interactive_mode(SpotifyToken *token) {
+    // Results of each command live in one arena, released when the command returns
+    SpotifyArena *arena = spotify_arena_new(0);
+
     while (1) {
         print_menu();
 
@@ -535,9 +551,13 @@ void interactive_mode(SpotifyToken *token) {
         }
         getchar(); // consume newline
 
+        SpotifyArena *previous = spotify_arena_begin(arena);
+
         switch (choice) {
             case 1: // EXIT APP
                 printf("\nGoodbye!\n");
+                spotify_arena_end(previous);
+                spotify_arena_free(arena);
                 return;
             case 2:  // VIEW OPTIONS
                 users_options();
@@ -615,79 +635,102 @@ void interactive_mode(SpotifyToken *token) {
             default:
                 printf("Invalid option. Please try again.\n");
         }
-    }
-}
 
-int main(int argc, char *argv[]) {
-    // Load environment variables from .env file
-    load_dotenv(".env");
-
-    SpotifyToken token;
-
-    // Authenticate first
-    if (!spotify_get_access_token(&token)) {
-        fprintf(stderr, "Failed to get access token.\n");
-        return 1;
+        spotify_arena_end(previous);
+        spotify_arena_reset(arena);
     }
+}
 
-    // No arguments - show usage
+// Command line, parsed before anything touches the token
+typedef struct {
+    bool list_mode;
+    bool player_state;
+    bool interactive;
+    bool stats;
+    bool daemon;
+    bool watch;
+    bool trace;
+    const char *search_type;
+    const char *query;
+} CliOptions;
+
+/**
+ * Parse argv into options
+ * Returns -1 to go on, or the exit status when there is nothing to run (--help, bad flag)
+ */
+static int parse_options(int argc, char *argv[], CliOptions *options) {
+    memset(options, 0, sizeof(*options));
+    options->search_type = "track";
+
+    // No arguments - interactive mode
     if (argc < 2) {
-        printf("✅ Authenticated successfully!\n");
-        printf("Starting interactive mode...\n");
-        interactive_mode(&token);
-        return 0;
+        options->interactive = true;
+        return -1;
     }
 
-    // Parse command line options
-    int opt;
-    int list_mode = 0;
-    int player_state = 0;
-    int interactive = 0;
-    char *search_type = "track";
+    // getopt keeps state between calls; the daemon parses many command lines
+    optind = 0;
 
     static struct option long_options[] = {
-        {"track",       no_argument, 0, 't'},
-        {"artist",      no_argument, 0, 'a'},
-        {"album",       no_argument, 0, 'A'},
-        {"playlist",    no_argument, 0, 'p'},
-        {"player",      no_argument, 0, 'P'},
-        {"user",        no_argument, 0, 'u'},
-        {"audiobook",   no_argument, 0, 'b'},
-        {"list",        no_argument, 0, 'l'},
-        {"interactive", no_argument, 0, 'i'},
-        {"help",        no_argument, 0, 'h'},
+        {"track",         no_argument, 0, 't'},
+        {"artist",        no_argument, 0, 'a'},
+        {"album",         no_argument, 0, 'A'},
+        {"playlist",      no_argument, 0, 'p'},
+        {"player",        no_argument, 0, 'P'},
+        {"user",          no_argument, 0, 'u'},
+        {"audiobook",     no_argument, 0, 'b'},
+        {"list",          no_argument, 0, 'l'},
+        {"interactive",   no_argument, 0, 'i'},
+        {"stats",         no_argument, 0, 's'},
+        {"daemon",        no_argument, 0, 'D'},
+        {"watch",         no_argument, 0, 'W'},
+        {"startup-trace", no_argument, 0, 'T'},
+        {"help",          no_argument, 0, 'h'},
         {0, 0, 0, 0}
     };
 
+    int opt;
     int option_index = 0;
-    while ((opt = getopt_long(argc, argv, "taApPublih", long_options, &option_index)) != -1) {
+    while ((opt = getopt_long(argc, argv, "taApPublish", long_options, &option_index)) != -1) {
         switch (opt) {
             case 't':
-                search_type = "track";
+                options->search_type = "track";
                 break;
             case 'a':
-                search_type = "artist";
+                options->search_type = "artist";
                 break;
             case 'A':
-                search_type = "album";
+                options->search_type = "album";
                 break;
             case 'p':
-                search_type = "playlist";
+                options->search_type = "playlist";
                 break;
             case 'P':
-                player_state = 1;
+                options->player_state = true;
                 break;
             case 'u':
-                search_type = "user";
+                options->search_type = "user";
                 break;
             case 'b':
-                search_type = "audiobook";
+                options->search_type = "audiobook";
                 break;
             case 'l':
-                list_mode = 1;
+                options->list_mode = true;
                 break;
             case 'i':
-                interactive = 1;
+                options->interactive = true;
+                break;
+            case 's':
+                options->stats = true;
+                break;
+            case 'D':
+                options->daemon = true;
+                break;
+            case 'W':
+                options->watch = true;
+                break;
+            case 'T':
+                options->trace = true;
                 break;
             case 'h':
                 print_usage(argv[0]);
@@ -698,43 +741,62 @@ int main(int argc, char *argv[]) {
         }
     }
 
-    printf("✅ Authenticated successfully!\n");
+    // Search mode - need a query
+    bool search = !options->interactive && !options->list_mode &&
+                  !options->player_state && !options->daemon && !options->watch;
+    if (search && optind >= argc) {
+        fprintf(stderr, "Error: Search query required.\n");
+        print_usage(argv[0]);
+        return 1;
+    }
+    options->query = optind < argc ? argv[optind] : NULL;
 
+    return -1;
+}
+
+/**
+ * Run a parsed command line against an authenticated token
+ * Returns the exit status
+ */
+static int execute_command(SpotifyToken *token, const CliOptions *options) {
     // Interactive mode
-    if (interactive) {
-        interactive_mode(&token);
+    if (options->interactive) {
+        printf("✅ Authenticated successfully!\n");
+        printf("Starting interactive mode...\n");
+        interactive_mode(token);
         return 0;
     }
 
+    // Watch mode: stdout carries nothing but events
+    if (options->watch) {
+        return watch_player(token);
+    }
+
+    printf("✅ Authenticated successfully!\n");
+
     // List mode
-    if (list_mode) {
-        view_saved_tracks(&token);
+    if (options->list_mode) {
+        view_saved_tracks(token);
         return 0;
     }
 
-    if (player_state) {
-        SpotifyPlayerState *state = spotify_get_player_state(&token);
+    if (options->player_state) {
+        SpotifyPlayerState *state = spotify_get_player_state(token);
         spotify_print_player_state(state);
         spotify_free_player_state(state);
         return 0;
     }
 
-    // Search mode - need a query
-    if (optind >= argc) {
-        fprintf(stderr, "Error: Search query required.\n");
-        print_usage(argv[0]);
-        return 1;
-    }
-
-    char *query = argv[optind];
+    const char *search_type = options->search_type;
+    const char *query = options->query;
 
     // Handle different search types
     if (strcmp(search_type, "track") == 0) {
-        search_and_save(&token, query);
+        search_and_save(token, query);
     } else if (strcmp(search_type, "artist") == 0) {
-        search_artists(&token, query);
+        search_artists(token, query);
     } else if (strcmp(search_type, "album") == 0) {
-        search_artist_and_view_albums(&token, query);
+        search_artist_and_view_albums(token, query);
     } else if (strcmp(search_type, "playlist") == 0 ||
             strcmp(search_type, "user") == 0 ||
             strcmp(search_type, "audiobook") == 0) {
@@ -749,6 +811,127 @@ int main(int argc, char *argv[]) {
     return 0;
 }
 
+// Runs one command line forwarded to the daemon
+static int daemon_command(int argc, char *argv[], void *userdata) {
+    CliOptions options;
+    int status = parse_options(argc, argv, &options);
+    if (status >= 0) return status;
+
+    if (options.daemon) {
+        fprintf(stderr, "Already running as a daemon\n");
+        return 1;
+    }
+    if (options.interactive || options.watch) {
+        fprintf(stderr, "Interactive and watch mode cannot run in the daemon\n");
+        return 1;
+    }
+
+    status = execute_command(userdata, &options);
+    if (options.stats) spotify_print_request_stats();
+    return status;
+}
+
+/**
+ * Interactive sessions and watchers run until the user stops them; anything else may run in the daemon
+ * Decided on the parsed options, so abbreviations like --inter count too
+ */
+static bool forwardable(const CliOptions *options) {
+    return !options->interactive && !options->daemon && !options->watch;
+}
+
+// ===== STARTUP =====
+
+static double elapsed_ms(const struct timespec *since) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - since->tv_sec) * 1000.0 + (now.tv_nsec - since->tv_nsec) / 1e6;
+}
+
+static void trace_phase(bool trace, const char *phase, double ms) {
+    if (trace) fprintf(stderr, "[startup] %-20s %8.1f ms\n", phase, ms);
+}
+
+// Connection warm-up running next to token validation
+typedef struct {
+    pthread_t thread;
+    bool started;
+    bool ok;
+    double ms;
+} WarmUp;
+
+static void* warm_up_main(void *arg) {
+    WarmUp *warm = arg;
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    warm->ok = spotify_warm_connection(NULL);
+    warm->ms = elapsed_ms(&start);
+    return NULL;
+}
+
+// The warm-up borrows a pooled handle: join it before anything can free the pool
+static void warm_up_join(WarmUp *warm) {
+    if (!warm->started) return;
+    pthread_join(warm->thread, NULL);
+    warm->started = false;
+}
+
+int main(int argc, char *argv[]) {
+    struct timespec start, phase;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    // Arguments first: --help and bad flags never touch the token
+    clock_gettime(CLOCK_MONOTONIC, &phase);
+    CliOptions options;
+    int status = parse_options(argc, argv, &options);
+    if (status >= 0) return status;
+
+    // A running daemon already holds a warm token and connections
+    if (forwardable(&options) && daemon_forward(argc, argv, &status)) {
+        return status;
+    }
+    trace_phase(options.trace, "parse arguments", elapsed_ms(&phase));
+
+    // Load environment variables from .env file
+    // Before any thread starts: setenv() must not race getenv() (proxy, cache settings)
+    clock_gettime(CLOCK_MONOTONIC, &phase);
+    load_dotenv(".env");
+    trace_phase(options.trace, "load .env", elapsed_ms(&phase));
+
+    // Connect to the API while the token is loaded (and maybe refreshed)
+    WarmUp warm = {0};
+    warm.started = pthread_create(&warm.thread, NULL, warm_up_main, &warm) == 0;
+
+    // Outlives main(): the background refresher may read it until exit
+    static SpotifyToken token;
+
+    clock_gettime(CLOCK_MONOTONIC, &phase);
+    if (!spotify_get_access_token(&token)) {
+        fprintf(stderr, "Failed to get access token.\n");
+        warm_up_join(&warm);
+        return 1;
+    }
+    spotify_token_keep_fresh(&token);
+    trace_phase(options.trace, "token", elapsed_ms(&phase));
+
+    clock_gettime(CLOCK_MONOTONIC, &phase);
+    warm_up_join(&warm);
+    trace_phase(options.trace, warm.ok ? "connect (parallel)" : "connect (failed)", warm.ms);
+    trace_phase(options.trace, "waited for connect", elapsed_ms(&phase));
+    trace_phase(options.trace, "ready", elapsed_ms(&start));
+
+    if (options.daemon) {
+        return daemon_serve(daemon_command, &token);
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &phase);
+    status = execute_command(&token, &options);
+    trace_phase(options.trace, "command", elapsed_ms(&phase));
+
+    if (options.stats) spotify_print_request_stats();
+    return status;
+}
+
 void create_playlist_interactive(SpotifyToken *token) {
     printf("\n=== Create New Playlist ===\n");
     
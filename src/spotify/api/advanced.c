@@ -339,8 +339,8 @@ SpotifyRecentlyPlayed* spotify_get_recently_played(SpotifyToken *token, int limi
     }
 
     int count = json_object_array_length(items);
-    SpotifyRecentlyPlayed *history = malloc(sizeof(SpotifyRecentlyPlayed));
-    history->history = malloc(sizeof(SpotifyPlayHistory) * count);
+    SpotifyRecentlyPlayed *history = spotify_mem_alloc(sizeof(SpotifyRecentlyPlayed));
+    history->history = spotify_mem_calloc(count, sizeof(SpotifyPlayHistory));
     history->count = count;
 
     for (int i = 0; i < count; i++) {
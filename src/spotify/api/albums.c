@@ -221,6 +221,60 @@ SpotifyAlbumList* spotify_get_user_saved_albums(SpotifyToken *token, int limit,
     return list;
 }
 
+/**
+ * Get every saved album of the current user
+ * Reads total from the first page and fetches the remaining pages concurrently
+ */
+SpotifyAlbumList* spotify_get_all_user_saved_albums(SpotifyToken *token) {
+    SpotifyAlbumList *list = spotify_get_user_saved_albums(token, SPOTIFY_MAX_LIMIT_ALBUMS, 0);
+    if (!list || list->count >= list->total) return list;
+
+    int page_count = 0;
+    SpotifyResponse *pages = spotify_fetch_pages(token, ENDPOINT_USER_ALBUMS,
+                                                 SPOTIFY_MAX_LIMIT_ALBUMS, list->count,
+                                                 list->total, SPOTIFY_SINK_JSON, &page_count);
+    if (!pages) {
+        spotify_free_album_list(list);
+        return NULL;
+    }
+
+    int extra = 0;
+    for (int p = 0; p < page_count; p++) {
+        struct json_object *items = spotify_page_items(&pages[p]);
+        if (items) extra += json_object_array_length(items);
+    }
+
+    SpotifyAlbum *grown = realloc(list->albums, sizeof(SpotifyAlbum) * (list->count + extra));
+    if (!grown) {
+        spotify_free_pages(pages, page_count);
+        spotify_free_album_list(list);
+        return NULL;
+    }
+    list->albums = grown;
+
+    for (int p = 0; p < page_count; p++) {
+        struct json_object *items = spotify_page_items(&pages[p]);
+        if (!items) continue;
+
+        int n = json_object_array_length(items);
+        for (int i = 0; i < n; i++) {
+            struct json_object *item = json_object_array_get_idx(items, i);
+            struct json_object *album;
+            SpotifyAlbum *slot = &list->albums[list->count++];
+
+            // Saved albums are wrapped in an object with "added_at" and "album" fields
+            if (json_object_object_get_ex(item, "album", &album)) {
+                parse_album_json(album, slot);
+            } else {
+                memset(slot, 0, sizeof(SpotifyAlbum));
+            }
+        }
+    }
+
+    spotify_free_pages(pages, page_count);
+    return list;
+}
+
 bool spotify_save_albums(SpotifyToken *token, const chat **album_ids, int count) {
     // Build JSON Body
     struct json_object *root = json_object_new_object();
@@ -263,47 +317,20 @@ bool spotify_remove_albums(SpotifyToken *token, const char **album_ids, int coun
     json_object_object_add(root, "ids", ids_array);
     const char *json_str = json_object_to_json_string(root);
 
-    // Spotify's DELETE /v1/me/albums returns 200 OK (not 204)
-    // So we need a custom implementation for this endpoint
-    CURL *curl = curl_easy_init();
-    if (!curl) {
-        json_object_put(root);
-        return false;
-    }
-
-    char auth_header[1024];
-    snprintf(auth_header, sizeof(auth_header), "Authorization: Bearer %s", token->access_token);
-
-    struct curl_slist *headers = NULL;
-    headers = curl_slist_append(headers, auth_header);
-    headers = curl_slist_append(headers, "Content-Type: application/json");
-
-    curl_easy_setopt(curl, CURLOPT_URL, url);
-    curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, "DELETE");
-    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
-    curl_easy_setopt(curl, CURLOPT_POSTFIELDS, json_str);
-
-    CURLcode res = curl_easy_perform(curl);
-
-    long response_code;
-    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response_code);
-
-    curl_slist_free_all(headers);
-    curl_easy_cleanup(curl);
+    // Spotify's DELETE /v1/me/albums returns 200 OK with an empty body
+    SpotifyRequest request = {
+        .method = SPOTIFY_METHOD_DELETE,
+        .url = url,
+        .body = json_str,
+        .expected_status = {200}
+    };
+
+    SpotifyResponse response;
+    bool result = spotify_request_perform(token, &request, &response);
+    spotify_response_free(&response);
     json_object_put(root);
 
-    if (res != CURLE_OK) {
-        fprintf(stderr, "CURL error: %s\n", curl_easy_strerror(res));
-        return false;
-    }
-
-    // Spotify returns 200 OK for this endpoint
-    if (response_code != 200) {
-        fprintf(stderr, "HTTP error: %ld\n", response_code);
-        return false;
-    }
-
-    return true;
+    return result;
 }
 
 bool* spotify_check_saved_albums(SpotifyToken *token, const char **album_ids, int count, int *result_count) {
@@ -70,63 +70,98 @@ SpotifyArtist* spotify_get_artist(SpotifyToken *token, const char *artist_id) {
     return artist;
 }
 
+/**
+ * Get several artists by ID
+ * More than 50 IDs are split into chunks fetched concurrently
+ */
 SpotifyArtistList* spotify_get_artists(SpotifyToken *token, const char **artist_ids, int count) {
-    if (!token || !artist_ids || count <= 0 || count > 50) {
-        fprintf(stderr, "Invalid parameters (max 50 artists)\n");
+    if (!token || !artist_ids || count <= 0) {
+        fprintf(stderr, "Invalid parameters for get_artists\n");
         return NULL;
     }
 
-    // Build URL with query parameters
-    char url[2048] = "https://api.spotify.com/v1/artists?ids=";
-    
-    for (int i = 0; i < count; i++) {
-        if (i > 0) strcat(url, ",");
-        strcat(url, artist_ids[i]);
-    }
+    int chunks = (count + SPOTIFY_MAX_BATCH_ARTISTS - 1) / SPOTIFY_MAX_BATCH_ARTISTS;
 
-    struct json_object *root = spotify_api_get(token, url);
-    if (!root) {
-        fprintf(stderr, "Failed to get artists\n");
+    char (*urls)[2048] = malloc(sizeof(*urls) * chunks);
+    SpotifyRequest *requests = calloc(chunks, sizeof(SpotifyRequest));
+    SpotifyResponse *responses = calloc(chunks, sizeof(SpotifyResponse));
+    if (!urls || !requests || !responses) {
+        free(urls);
+        free(requests);
+        free(responses);
         return NULL;
     }
 
-    struct json_object *artists_array;
-    if (!json_object_object_get_ex(root, "artists", &artists_array)) {
-        fprintf(stderr, "No 'artists' field in response\n");
-        json_object_put(root);
-        return NULL;
-    }
+    for (int c = 0; c < chunks; c++) {
+        int first = c * SPOTIFY_MAX_BATCH_ARTISTS;
+        int n = count - first < SPOTIFY_MAX_BATCH_ARTISTS ? count - first : SPOTIFY_MAX_BATCH_ARTISTS;
 
-    int actual_count = json_object_array_length(artists_array);
-    
-    SpotifyArtistList *list = malloc(sizeof(SpotifyArtistList));
-    if (!list) {
-        json_object_put(root);
-        return NULL;
+        spotify_build_ids_url(urls[c], sizeof(urls[c]), ENDPOINT_ARTISTS, &artist_ids[first], n);
+
+        requests[c].method = SPOTIFY_METHOD_GET;
+        requests[c].url = urls[c];
+        requests[c].sink = SPOTIFY_LISTING_SINK;
     }
 
-    list->artists = malloc(sizeof(SpotifyArtist) * actual_count);
-    if (!list->artists) {
-        free(list);
-        json_object_put(root);
-        return NULL;
+    SpotifyArtistList *list = NULL;
+    int succeeded = spotify_request_batch(token, requests, chunks, responses, NULL, NULL, NULL);
+    if (succeeded != chunks) {
+        fprintf(stderr, "Failed to get artists\n");
+        goto cleanup;
     }
 
-    list->count = actual_count;
-    list->total = actual_count;
-
-    for (int i = 0; i < actual_count; i++) {
-        struct json_object *item = json_object_array_get_idx(artists_array, i);
-        
-        // Handle null entries (invalid IDs)
-        if (item && json_object_get_type(item) != json_type_null) {
-            parse_artist_json(item, &list->artists[i]);
-        } else {
-            memset(&list->artists[i], 0, sizeof(SpotifyArtist));
+    list = calloc(1, sizeof(SpotifyArtistList));
+    if (!list) goto cleanup;
+
+    for (int c = 0; c < chunks; c++) {
+        if (responses[c].body) {
+            if (fast_parse_artist_items(responses[c].body, responses[c].body_size, "artists",
+                                        &list->artists, &list->count) < 0) {
+                fprintf(stderr, "Failed to parse artists response\n");
+                goto fail;
+            }
+            continue;
+        }
+
+        struct json_object *artists_array;
+        if (!responses[c].json ||
+            !json_object_object_get_ex(responses[c].json, "artists", &artists_array)) {
+            fprintf(stderr, "No 'artists' field in response\n");
+            goto fail;
+        }
+
+        int n = json_object_array_length(artists_array);
+        SpotifyArtist *grown = realloc(list->artists, sizeof(SpotifyArtist) * (list->count + n));
+        if (!grown && list->count + n > 0) goto fail;
+        list->artists = grown;
+
+        for (int i = 0; i < n; i++) {
+            struct json_object *item = json_object_array_get_idx(artists_array, i);
+            SpotifyArtist *slot = &list->artists[list->count++];
+
+            // Handle null entries (invalid IDs)
+            if (item && json_object_get_type(item) != json_type_null) {
+                parse_artist_json(item, slot);
+            } else {
+                memset(slot, 0, sizeof(SpotifyArtist));
+            }
         }
     }
 
-    json_object_put(root);
+    list->total = list->count;
+    goto cleanup;
+
+fail:
+    spotify_free_artist_list(list);
+    list = NULL;
+
+cleanup:
+    for (int c = 0; c < chunks; c++) {
+        spotify_response_free(&responses[c]);
+    }
+    free(responses);
+    free(requests);
+    free(urls);
     return list;
 }
 
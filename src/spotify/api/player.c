@@ -1,13 +1,73 @@
 #include "spotify/spotify_player.h"
 #include <stdio.h>
+#include <string.h>
 
-static char *context_repeat[] = {"off", "context", "track"};
-static int context_index = 0;
+// Player state feeds status bars: answer quickly or not at all
+#define PLAYER_STATE_TIMEOUT_MS 5000
 
-SpotifyPlayerState* spotify_get_player_state(SpotifyToken *token) {
+#ifdef SPOTIFY_FAST_PARSE
+/**
+ * Fetch a player state endpoint and parse the raw body without a json-c tree
+ * Returns NULL on error or when nothing is playing (204, empty body)
+ */
+static SpotifyPlayerState* fetch_player_state_fast(SpotifyToken *token, const char *url) {
+    SpotifyRequest request = {
+        .method = SPOTIFY_METHOD_GET,
+        .url = url,
+        .sink = SPOTIFY_SINK_BUFFER,
+        .timeout_ms = PLAYER_STATE_TIMEOUT_MS,
+        .hedge = true
+    };
+    SpotifyResponse response = {0};
+    SpotifyPlayerState *state = NULL;
+
+    if (spotify_request_perform(token, &request, &response) && response.body_size > 0) {
+        state = malloc(sizeof(SpotifyPlayerState));
+        if (state && !fast_parse_player_state(response.body, response.body_size, state)) {
+            free(state);
+            state = NULL;
+        }
+    }
+
+    spotify_response_free(&response);
+    return state;
+}
+#else
+/**
+ * Hedged GET of a player state endpoint, with a short deadline
+ */
+static struct json_object* fetch_player_json(SpotifyToken *token, const char *url) {
+    SpotifyRequest request = {
+        .method = SPOTIFY_METHOD_GET,
+        .url = url,
+        .sink = SPOTIFY_SINK_JSON,
+        .timeout_ms = PLAYER_STATE_TIMEOUT_MS,
+        .hedge = true
+    };
+    SpotifyResponse response;
+    struct json_object *root = NULL;
+
+    if (spotify_request_perform(token, &request, &response)) {
+        root = response.json;
+        response.json = NULL;
+    }
+
+    spotify_response_free(&response);
+    return root;
+}
+#endif
+
+static SpotifyPlayerState* fetch_player_state(SpotifyToken *token) {
     const char *url = "https://api.spotify.com/v1/me/player";
 
-    struct json_object *root = spotify_api_get(token, url);
+#ifdef SPOTIFY_FAST_PARSE
+    SpotifyPlayerState *fast_state = fetch_player_state_fast(token, url);
+    if (!fast_state) {
+        fprintf(stderr, "Failed to get player state (no active device or API error)\n");
+    }
+    return fast_state;
+#else
+    struct json_object *root = fetch_player_json(token, url);
     if (!root) {
         fprintf(stderr, "Failed to get player state (no active device or API error)\n");
         return NULL;
@@ -29,9 +89,82 @@ SpotifyPlayerState* spotify_get_player_state(SpotifyToken *token) {
     parse_player_state_json(root, state);
     json_object_put(root);
 
+    return state;
+#endif
+}
+
+/**
+ * Current player state, predicted by the client's player model while it can
+ * be, fetched otherwise (see SPOTIFY_PLAYER_DRIFT_CHECK_MS)
+ */
+SpotifyPlayerState* spotify_get_player_state(SpotifyToken *token) {
+    SpotifyPlayerState predicted;
+    if (spotify_player_model_get(token, &predicted)) {
+        SpotifyPlayerState *state = malloc(sizeof(SpotifyPlayerState));
+        if (state) *state = predicted;
+        return state;
+    }
+
+    // The reported progress was true somewhere during the request
+    long long sent_at = spotify_monotonic_ms();
+    SpotifyPlayerState *state = fetch_player_state(token);
+    if (state) {
+        spotify_player_model_store(token, state, (sent_at + spotify_monotonic_ms()) / 2);
+    }
     return state;
 }
 
+/**
+ * Fetch /me/player without asking the player model, for callers that watch
+ * for changes made elsewhere; the model adopts the result
+ *
+ * @param state - Filled when a device is active
+ * @param active - Set to false when no device is active (204, empty body)
+ * @return false if the request failed
+ */
+bool spotify_fetch_player_state(SpotifyToken *token, SpotifyPlayerState *state, bool *active) {
+    SpotifyRequest request = {
+        .method = SPOTIFY_METHOD_GET,
+        .url = ENDPOINT_PLAYER,
+#ifdef SPOTIFY_FAST_PARSE
+        .sink = SPOTIFY_SINK_BUFFER,
+#else
+        .sink = SPOTIFY_SINK_JSON,
+#endif
+        .timeout_ms = PLAYER_STATE_TIMEOUT_MS,
+        .bypass_cache = true,
+        .hedge = true
+    };
+    SpotifyResponse response;
+
+    long long sent_at = spotify_monotonic_ms();
+    bool ok = spotify_request_perform(token, &request, &response);
+
+#ifdef SPOTIFY_FAST_PARSE
+    *active = ok && response.body_size > 0 &&
+              fast_parse_player_state(response.body, response.body_size, state);
+#else
+    *active = ok && response.json && json_object_get_type(response.json) == json_type_object;
+    if (*active) parse_player_state_json(response.json, state);
+#endif
+
+    if (*active) {
+        spotify_player_model_store(token, state, (sent_at + spotify_monotonic_ms()) / 2);
+    }
+
+    spotify_response_free(&response);
+    return ok;
+}
+
+/**
+ * Pass through the result of a playback command after dropping the player
+ * model: what the command changed is only known to the player
+ */
+static bool player_command(SpotifyToken *token, bool sent) {
+    spotify_player_model_invalidate(token);
+    return sent;
+}
+
 bool spotify_skip_next_playback(SpotifyToken *token, const char *device_id) {
     char url[256];
 
@@ -43,7 +176,7 @@ bool spotify_skip_next_playback(SpotifyToken *token, const char *device_id) {
         snprintf(url, sizeof(url), "https://api.spotify.com/v1/me/player/next");
     }
 
-    return spotify_api_post_empty(token, url);
+    return player_command(token, spotify_api_post_empty(token, url));
 }
 
 bool spotify_skip_previous_playback(SpotifyToken *token, const char *device_id) {
@@ -57,31 +190,30 @@ bool spotify_skip_previous_playback(SpotifyToken *token, const char *device_id)
         snprintf(url, sizeof(url), "https://api.spotify.com/v1/me/player/previous");
     }
 
-    return spotify_api_post_empty(token, url);
+    return player_command(token, spotify_api_post_empty(token, url));
 }
 
 
 /**
  * Toggle between play and pause based on current state
+ * The state is fetched, not predicted: another device may have paused within
+ * the player model's drift window
  */
 bool spotify_toggle_playback(SpotifyToken *token) {
-    SpotifyPlayerState *state = spotify_get_player_state(token);
-    if (!state) {
+    SpotifyPlayerState state;
+    bool active = false;
+    if (!spotify_fetch_player_state(token, &state, &active) || !active) {
         fprintf(stderr, "Cannot toggle: no active playback\n");
         return false;
     }
 
-    bool result;
-    if (state->is_playing) {
+    if (state.is_playing) {
         printf("⏸ Pausing...\n");
-        result = spotify_pause_playback(token, NULL);
-    } else {
-        printf("▶ Resuming...\n");
-        result = spotify_resume_playback(token, NULL);
+        return spotify_pause_playback(token, NULL);
     }
 
-    spotify_free_player_state(state);
-    return result;
+    printf("▶ Resuming...\n");
+    return spotify_resume_playback(token, NULL);
 }
 
 bool spotify_toggle_playback_shuffle(SpotifyToken *token, const char *device_id, bool state_shuffle) {
@@ -96,24 +228,40 @@ bool spotify_toggle_playback_shuffle(SpotifyToken *token, const char *device_id,
                 "https://api.spotify.com/v1/me/player/shuffle?state=%d", state_shuffle);
     }
 
-    return spotify_api_put_empty(token, url);
+    return player_command(token, spotify_api_put_empty(token, url));
 }
 
+/**
+ * Cycle the repeat mode off -> context -> track -> off
+ * The next mode follows from the player's current one, freshly fetched rather
+ * than predicted or kept in process state, so it stays right across clients
+ * and other devices.
+ */
 bool spotify_toggle_playback_repeat(SpotifyToken *token, const char *device_id) {
+    const char *next = "context";
+
+    SpotifyPlayerState state;
+    bool active = false;
+    if (spotify_fetch_player_state(token, &state, &active) && active) {
+        if (strcmp(state.repeat_state, "context") == 0) {
+            next = "track";
+        } else if (strcmp(state.repeat_state, "track") == 0) {
+            next = "off";
+        }
+    }
+
     char url[256];
 
     if (device_id) {
         snprintf(url, sizeof(url),
                 "https://api.spotify.com/v1/me/player/repeat?state=%s&device_id=%s",
-                context_repeat[context_index++], device_id);
+                next, device_id);
     } else {
         snprintf(url, sizeof(url),
-                "https://api.spotify.com/v1/me/player/repeat?state=%s",
-                context_repeat[context_index++]);
+                "https://api.spotify.com/v1/me/player/repeat?state=%s", next);
     }
 
-    context_index++;
-    return spotify_api_put_empty(token, url);
+    return player_command(token, spotify_api_put_empty(token, url));
 }
 
 /**
@@ -137,7 +285,7 @@ bool spotify_transfer_playback(SpotifyToken *token, const char *device_id, bool
 
     const char *json_str = json_object_to_json_string(root);
 
-    bool result = spotify_api_put(token, url, json_str);
+    bool result = player_command(token, spotify_api_put(token, url, json_str));
 
     json_object_put(root);
     return result;
@@ -155,7 +303,7 @@ bool spotify_set_playback_volume(SpotifyToken *token, const char *device_id, int
                 "https://api.spotify.com/v1/me/player/volume?volume_percent=%d",
                 volume);
     }
-    return spotify_api_put_empty(token, url);
+    return player_command(token, spotify_api_put_empty(token, url));
 }
 
 /**
@@ -233,7 +381,7 @@ SpotifyQueue* spotify_get_queue(SpotifyToken *token) {
         return NULL;
     }
 
-    SpotifyQueue *queue = malloc(sizeof(SpotifyQueue));
+    SpotifyQueue *queue = spotify_mem_alloc(sizeof(SpotifyQueue));
     if (!queue) {
         fprintf(stderr, "Failed to allocate memory for queue\n");
         json_object_put(root);
@@ -288,7 +436,7 @@ bool spotify_pause_playback(SpotifyToken *token, const char *device_id) {
         snprintf(url, sizeof(url), "https://api.spotify.com/v1/me/player/pause");
     }
 
-    return spotify_api_put_empty(token, url);
+    return player_command(token, spotify_api_put_empty(token, url));
 }
 
 /**
@@ -309,7 +457,7 @@ bool spotify_resume_playback(SpotifyToken *token, const char *device_id) {
         snprintf(url, sizeof(url), "https://api.spotify.com/v1/me/player/play");
     }
 
-    return spotify_api_post(token, url, NULL);
+    return player_command(token, spotify_api_post(token, url, NULL));
 }
 
 /**
@@ -359,7 +507,7 @@ bool spotify_start_playback(SpotifyToken *token, const char *device_id,
         json_str = json_object_to_json_string(root);
     }
 
-    bool result = spotify_api_post(token, url, json_str);
+    bool result = player_command(token, spotify_api_post(token, url, json_str));
 
     if (root) {
         json_object_put(root);
@@ -376,7 +524,14 @@ SpotifyPlayerState* spotify_get_currently_playing(SpotifyToken *token) {
 
     const char *url = ENDPOINT_CURRENTLY_PLAYING;
 
-    struct json_object *root = spotify_api_get(token, url);
+#ifdef SPOTIFY_FAST_PARSE
+    SpotifyPlayerState *fast_state = fetch_player_state_fast(token, url);
+    if (!fast_state) {
+        fprintf(stderr, "Failed to get currently playing track (no active device or API error)\n");
+    }
+    return fast_state;
+#else
+    struct json_object *root = fetch_player_json(token, url);
     if (!root) {
         fprintf(stderr, "Failed to get currently playing track (no active device or API error)\n");
         return NULL;
@@ -400,6 +555,7 @@ SpotifyPlayerState* spotify_get_currently_playing(SpotifyToken *token) {
     json_object_put(root);
 
     return state;
+#endif
 }
 
 bool spotify_seek_to_position(SpotifyToken *token, int position_ms, const char *device_id) {
@@ -420,5 +576,5 @@ bool spotify_seek_to_position(SpotifyToken *token, int position_ms, const char *
                 ENDPOINT_PLAYER_SEEK, position_ms);
     }
 
-    return spotify_api_put_empty(token, url);
+    return player_command(token, spotify_api_put_empty(token, url));
 }
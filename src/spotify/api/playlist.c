@@ -3,6 +3,125 @@
 #include <string.h>
 #include <stdio.h>
 
+#define PLAYLIST_TRACK_FIELDS "items(track(id,name,uri,duration_ms,artists(name),album(name))),total"
+
+/**
+ * Fetch tracks [*count, total) of a playlist concurrently and append them to *tracks
+ */
+static bool playlist_tracks_append(SpotifyToken *token, const char *playlist_id,
+                                   SpotifyTrack **tracks, int *count, int total) {
+    char url[512];
+    snprintf(url, sizeof(url), ENDPOINT_PLAYLIST_TRACKS "?fields=" PLAYLIST_TRACK_FIELDS, playlist_id);
+
+    int page_count = 0;
+    SpotifyResponse *pages = spotify_fetch_pages(token, url, 100, *count, total,
+                                                 SPOTIFY_LISTING_SINK, &page_count);
+    if (!pages) return false;
+
+    bool ok = spotify_append_track_pages(tracks, count, pages, page_count, "track");
+    spotify_free_pages(pages, page_count);
+
+    return ok;
+}
+
+/**
+ * Read the current snapshot_id of a playlist straight from the server
+ */
+static bool playlist_snapshot(SpotifyToken *token, const char *playlist_id, char *snapshot, size_t size) {
+    char url[256];
+    snprintf(url, sizeof(url), ENDPOINT_PLAYLIST "?fields=snapshot_id", playlist_id);
+
+    SpotifyRequest request = {
+        .method = SPOTIFY_METHOD_GET,
+        .url = url,
+        .sink = SPOTIFY_SINK_JSON,
+        .bypass_cache = true
+    };
+    SpotifyResponse response;
+    bool ok = spotify_request_perform(token, &request, &response);
+
+    struct json_object *snapshot_obj;
+    ok = ok && json_object_object_get_ex(response.json, "snapshot_id", &snapshot_obj);
+    if (ok) {
+        snprintf(snapshot, size, "%s", json_object_get_string(snapshot_obj));
+    }
+
+    spotify_response_free(&response);
+    return ok;
+}
+
+/**
+ * Result of a change to a playlist's tracks, takes ownership of response
+ * The returned snapshot_id is remembered as the baseline for the next change
+ */
+static SpotifyPlaylistResult* playlist_result(SpotifyToken *token, const char *playlist_id,
+                                              struct json_object *response) {
+    SpotifyPlaylistResult *result = malloc(sizeof(SpotifyPlaylistResult));
+    if (!result) {
+        json_object_put(response);
+        return NULL;
+    }
+
+    result->success = true;
+    result->snapshot_id[0] = '\0';
+
+    struct json_object *snapshot_obj;
+    if (json_object_object_get_ex(response, "snapshot_id", &snapshot_obj)) {
+        snprintf(result->snapshot_id, sizeof(result->snapshot_id), "%s",
+                 json_object_get_string(snapshot_obj));
+    }
+    spotify_session_store_playlist_snapshot(token, playlist_id, result->snapshot_id);
+
+    json_object_put(response);
+    return result;
+}
+
+/**
+ * Every track of a playlist at snapshot_id
+ * The full track set is stored per snapshot_id, so an unchanged playlist is
+ * read from disk instead of being downloaded again; a changed one is
+ * downloaded completely once and stored
+ */
+static bool playlist_tracks_all(SpotifyToken *token, const char *playlist_id, const char *snapshot_id,
+                                int total, SpotifyTrack **tracks, int *count) {
+    if (spotify_playlist_store_load(playlist_id, snapshot_id, tracks, count) && *count == total) {
+        return true;
+    }
+    free(*tracks);
+    *tracks = NULL;
+    *count = 0;
+
+    if (!playlist_tracks_append(token, playlist_id, tracks, count, total)) {
+        spotify_mem_free(*tracks);
+        *tracks = NULL;
+        *count = 0;
+        return false;
+    }
+
+    // Only a complete track set can stand in for the playlist later
+    if (*count == total) {
+        spotify_playlist_store_save(playlist_id, snapshot_id, *tracks, *count);
+    }
+    return true;
+}
+
+/**
+ * Fill playlist->tracks with its first wanted tracks, sliced from the full set
+ */
+static bool playlist_tracks_load(SpotifyToken *token, const char *playlist_id,
+                                 SpotifyPlaylistFull *playlist, int total, int wanted) {
+    SpotifyTrack *tracks = NULL;
+    int count = 0;
+
+    if (!playlist_tracks_all(token, playlist_id, playlist->snapshot_id, total, &tracks, &count)) {
+        return false;
+    }
+
+    playlist->tracks = tracks;
+    playlist->tracks_count = count < wanted ? count : wanted;
+    return true;
+}
+
 SpotifyPlaylistFull* spotify_create_playlist(SpotifyToken *token, const char *name, const char *description, bool is_public, bool is_collaborative) {
     if (!token || !name) {
         fprintf(stderr, "Invalid parameters for create_playlist\n");
@@ -35,6 +154,7 @@ SpotifyPlaylistFull* spotify_create_playlist(SpotifyToken *token, const char *na
     // Use POST request that returns JSON response
     struct json_object *response = spotify_api_post_json(token, url, json_str);
     json_object_put(body);
+    spotify_session_invalidate_playlists(token);
 
     if (!response) {
         fprintf(stderr, "Failed to create playlist\n");
@@ -59,23 +179,15 @@ SpotifyPlaylistFull* spotify_get_playlist(SpotifyToken *token, const char *playl
         return NULL;
     }
 
+    // Track pages are fetched concurrently, 100 per request
     if (track_limit <= 0) track_limit = 100;
-    if (track_limit > 100) track_limit = 100;
 
+    // Metadata only: snapshot_id tells whether the stored track set is still valid
     char url[512];
-    if (fetch_tracks) {
-        snprintf(url, sizeof(url),
-                 "https://api.spotify.com/v1/playlists/%s?fields=id,name,description,uri,"
-                 "snapshot_id,public,collaborative,owner(id,display_name),"
-                 "tracks(total,items(track(id,name,uri,duration_ms,artists(name),album(name))))"
-                 "&limit=%d",
-                 playlist_id, track_limit);
-    } else {
-        snprintf(url, sizeof(url),
-                 "https://api.spotify.com/v1/playlists/%s?fields=id,name,description,uri,"
-                 "snapshot_id,public,collaborative,owner(id,display_name),tracks(total)",
-                 playlist_id);
-    }
+    snprintf(url, sizeof(url),
+             "https://api.spotify.com/v1/playlists/%s?fields=id,name,description,uri,"
+             "snapshot_id,public,collaborative,owner(id,display_name),tracks(total)",
+             playlist_id);
 
     struct json_object *root = spotify_api_get(token, url);
     if (!root) {
@@ -92,6 +204,16 @@ SpotifyPlaylistFull* spotify_get_playlist(SpotifyToken *token, const char *playl
     parse_playlist_full_json(root, playlist);
     json_object_put(root);
 
+    if (fetch_tracks) {
+        int total = playlist->tracks_count;
+        int wanted = total < track_limit ? total : track_limit;
+
+        playlist->tracks_count = 0;
+        if (wanted > 0 && !playlist_tracks_load(token, playlist_id, playlist, total, wanted)) {
+            fprintf(stderr, "Failed to get playlist tracks\n");
+        }
+    }
+
     return playlist;
 }
 
@@ -125,6 +247,8 @@ bool spotify_update_playlist(SpotifyToken *token, const char *playlist_id, Spoti
 
     bool result = spotify_api_put(token, url, json_str);
     json_object_put(body);
+    spotify_session_invalidate_playlists(token);
+    spotify_session_store_playlist_snapshot(token, playlist_id, "");
 
     return result;
 }
@@ -159,30 +283,58 @@ SpotifyPlaylistResult* spotify_add_tracks_to_playlist(SpotifyToken *token, const
 
     const char *json_str = json_object_to_json_string(body);
 
-    struct json_object *response = spotify_api_post_json(token, url, json_str);
-    json_object_put(body);
+    // The snapshot before the add tells a failed POST apart from a lost response.
+    // The previous change's snapshot serves, so a series of adds only asks once
+    char before[128];
+    bool checkable = spotify_session_playlist_snapshot(token, playlist_id, before, sizeof(before)) ||
+                     playlist_snapshot(token, playlist_id, before, sizeof(before));
+
+    SpotifyRequest request = {
+        .method = SPOTIFY_METHOD_POST,
+        .url = url,
+        .body = json_str,
+        .expected_status = {200, 201},
+        .sink = SPOTIFY_SINK_JSON,
+        .retry = SPOTIFY_RETRY_NEVER
+    };
+    SpotifyResponse reply;
+    bool ok = false;
+
+    for (int attempt = 0; ; attempt++) {
+        ok = spotify_request_perform(token, &request, &reply);
+        if (ok || !checkable || attempt >= SPOTIFY_RETRY_MAX_ATTEMPTS ||
+            !spotify_retry_transient(&reply)) {
+            break;
+        }
 
-    if (!response) {
-        fprintf(stderr, "Failed to add tracks to playlist\n");
-        return NULL;
-    }
+        // Resending is only safe if the playlist did not change
+        char after[128];
+        if (!playlist_snapshot(token, playlist_id, after, sizeof(after)) || strcmp(after, before) != 0) {
+            fprintf(stderr, "Playlist changed after a failed add, not retrying\n");
+            break;
+        }
 
-    SpotifyPlaylistResult *result = malloc(sizeof(SpotifyPlaylistResult));
-    if (!result) {
-        json_object_put(response);
-        return NULL;
+        spotify_response_free(&reply);
+        spotify_sleep_ms(spotify_retry_backoff_ms(attempt));
     }
 
-    result->success = true;
+    json_object_put(body);
+    spotify_session_invalidate_playlists(token);
 
-    struct json_object *snapshot_obj;
-    if (json_object_object_get_ex(response, "snapshot_id", &snapshot_obj)) {
-        strncpy(result->snapshot_id, json_object_get_string(snapshot_obj),
-                sizeof(result->snapshot_id) - 1);
+    struct json_object *response = NULL;
+    if (ok) {
+        response = reply.json;
+        reply.json = NULL;
     }
+    spotify_response_free(&reply);
 
-    json_object_put(response);
-    return result;
+    if (!response) {
+        spotify_session_store_playlist_snapshot(token, playlist_id, "");
+        fprintf(stderr, "Failed to add tracks to playlist\n");
+        return NULL;
+    }
+
+    return playlist_result(token, playlist_id, response);
 }
 SpotifyPlaylistResult* spotify_remove_tracks_from_playlist(SpotifyToken *token, const char *playlist_id, const char **track_uris, int count, const char *snapshot_id) {
     if (!token || !playlist_id || !track_uris || count <= 0) {
@@ -218,27 +370,14 @@ SpotifyPlaylistResult* spotify_remove_tracks_from_playlist(SpotifyToken *token,
 
     struct json_object *response = spotify_api_delete_json(token, url, json_str);
     json_object_put(body);
+    spotify_session_invalidate_playlists(token);
 
     if (!response) {
+        spotify_session_store_playlist_snapshot(token, playlist_id, "");
         fprintf(stderr, "Failed to remove tracks from playlist\n");
         return NULL;
     }
-    SpotifyPlaylistResult *result = malloc(sizeof(SpotifyPlaylistResult));
-    if (!result) {
-        json_object_put(response);
-        return NULL;
-    }
-
-    result->success = true;
-
-    struct json_object *snapshot_obj;
-    if (json_object_object_get_ex(response, "snapshot_id", &snapshot_obj)) {
-        strncpy(result->snapshot_id, json_object_get_string(snapshot_obj),
-                sizeof(result->snapshot_id) - 1);
-    }
-
-    json_object_put(response);
-    return result;
+    return playlist_result(token, playlist_id, response);
 }
 
 bool spotify_unfollow_playlist(SpotifyToken *token, const char *playlist_id) {
@@ -251,10 +390,17 @@ bool spotify_unfollow_playlist(SpotifyToken *token, const char *playlist_id) {
     snprintf(url, sizeof(url),
             "https://api.spotify.com/v1/playlists/%s/followers",
             playlist_id);
-    return spotify_api_delete_empty(token, url);
+
+    bool result = spotify_api_delete_empty(token, url);
+    spotify_session_invalidate_playlists(token);
+    return result;
 }
 
 SpotifyPlaylistList* spotify_get_user_playlists(SpotifyToken *token, int limit, int offset) {
+    // Pages are memoized for the session until one of our playlist mutations
+    SpotifyPlaylistList *memo = spotify_session_playlists(token, limit, offset);
+    if (memo) return memo;
+
     char url[256];
     snprintf(url, sizeof(url),
              "https://api.spotify.com/v1/me/playlists?limit=%d&offset=%d",
@@ -287,6 +433,7 @@ SpotifyPlaylistList* spotify_get_user_playlists(SpotifyToken *token, int limit,
     }
 
     json_object_put(root);
+    spotify_session_store_playlists(token, limit, offset, list);
     return list;
 }
 
@@ -303,7 +450,7 @@ SpotifyTrackList* spotify_get_playlist_tracks(SpotifyToken *token, const char *p
 
     char url[512];
     snprintf(url, sizeof(url),
-             "%s?limit=%d&offset=%d&fields=items(track(id,name,uri,duration_ms,artists(name),album(name))),total",
+             "%s?limit=%d&offset=%d&fields=" PLAYLIST_TRACK_FIELDS,
              ENDPOINT_PLAYLIST_TRACKS, limit, offset);
     
     // Replace %s with playlist_id
@@ -323,15 +470,15 @@ SpotifyTrackList* spotify_get_playlist_tracks(SpotifyToken *token, const char *p
     }
 
     int count = json_object_array_length(items);
-    SpotifyTrackList *list = malloc(sizeof(SpotifyTrackList));
+    SpotifyTrackList *list = spotify_mem_alloc(sizeof(SpotifyTrackList));
     if (!list) {
         json_object_put(root);
         return NULL;
     }
 
-    list->tracks = malloc(sizeof(SpotifyTrack) * count);
+    list->tracks = spotify_mem_alloc(sizeof(SpotifyTrack) * count);
     if (!list->tracks) {
-        free(list);
+        spotify_mem_free(list);
         json_object_put(root);
         return NULL;
     }
@@ -360,6 +507,82 @@ SpotifyTrackList* spotify_get_playlist_tracks(SpotifyToken *token, const char *p
     return list;
 }
 
+/**
+ * Get every track of a playlist
+ * Reads snapshot_id and total first, then takes the tracks from the playlist
+ * store or fetches every page concurrently
+ */
+SpotifyTrackList* spotify_get_all_playlist_tracks(SpotifyToken *token, const char *playlist_id) {
+    if (!token || !playlist_id) {
+        fprintf(stderr, "Invalid parameters for get_all_playlist_tracks\n");
+        return NULL;
+    }
+
+    char url[256];
+    snprintf(url, sizeof(url), ENDPOINT_PLAYLIST "?fields=snapshot_id,tracks(total)", playlist_id);
+
+    struct json_object *root = spotify_api_get(token, url);
+    if (!root) {
+        fprintf(stderr, "Failed to get playlist\n");
+        return NULL;
+    }
+
+    char snapshot_id[128] = "";
+    int total = 0;
+    struct json_object *obj, *total_obj;
+    if (json_object_object_get_ex(root, "snapshot_id", &obj)) {
+        snprintf(snapshot_id, sizeof(snapshot_id), "%s", json_object_get_string(obj));
+    }
+    if (json_object_object_get_ex(root, "tracks", &obj) &&
+        json_object_object_get_ex(obj, "total", &total_obj)) {
+        total = json_object_get_int(total_obj);
+    }
+    json_object_put(root);
+
+    SpotifyTrackList *list = spotify_mem_alloc(sizeof(SpotifyTrackList));
+    if (!list) return NULL;
+
+    list->tracks = NULL;
+    list->count = 0;
+    list->total = total;
+
+    if (total > 0 && !playlist_tracks_all(token, playlist_id, snapshot_id, total,
+                                          &list->tracks, &list->count)) {
+        fprintf(stderr, "Failed to get playlist tracks\n");
+        spotify_mem_free(list);
+        return NULL;
+    }
+
+    return list;
+}
+
+/**
+ * Get every playlist of the current user
+ * Reads total from the first page and fetches the remaining pages concurrently
+ */
+SpotifyPlaylistList* spotify_get_all_user_playlists(SpotifyToken *token) {
+    SpotifyPlaylistList *list = spotify_get_user_playlists(token, SPOTIFY_MAX_LIMIT_PLAYLISTS, 0);
+    if (!list || list->count >= list->total) return list;
+
+    int page_count = 0;
+    SpotifyResponse *pages = spotify_fetch_pages(token, ENDPOINT_USER_PLAYLISTS,
+                                                 SPOTIFY_MAX_LIMIT_PLAYLISTS, list->count,
+                                                 list->total, SPOTIFY_LISTING_SINK, &page_count);
+    if (!pages) {
+        spotify_free_playlist_list(list);
+        return NULL;
+    }
+
+    if (!spotify_append_playlist_pages(&list->playlists, &list->count, pages, page_count)) {
+        spotify_free_pages(pages, page_count);
+        spotify_free_playlist_list(list);
+        return NULL;
+    }
+
+    spotify_free_pages(pages, page_count);
+    return list;
+}
+
 SpotifyPlaylistResult* spotify_reorder_playlist_tracks(
     SpotifyToken *token,
     const char *playlist_id,
@@ -406,26 +629,13 @@ SpotifyPlaylistResult* spotify_reorder_playlist_tracks(
 
     struct json_object *response = spotify_api_put_json(token, url, json_str);
     json_object_put(body);
+    spotify_session_invalidate_playlists(token);
 
     if (!response) {
+        spotify_session_store_playlist_snapshot(token, playlist_id, "");
         fprintf(stderr, "Failed to reorder/replace playlist tracks\n");
         return NULL;
     }
 
-    SpotifyPlaylistResult *result = malloc(sizeof(SpotifyPlaylistResult));
-    if (!result) {
-        json_object_put(response);
-        return NULL;
-    }
-
-    result->success = true;
-
-    struct json_object *snapshot_obj;
-    if (json_object_object_get_ex(response, "snapshot_id", &snapshot_obj)) {
-        strncpy(result->snapshot_id, json_object_get_string(snapshot_obj),
-                sizeof(result->snapshot_id) - 1);
-    }
-
-    json_object_put(response);
-    return result;
+    return playlist_result(token, playlist_id, response);
 }
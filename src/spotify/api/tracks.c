@@ -19,8 +19,8 @@ SpotifyTrackList* spotify_search_tracks(SpotifyToken *token, const char *query,
     }
 
     int count = json_object_array_length(items);
-    SpotifyTrackList *list = malloc(sizeof(SpotifyTrackList));
-    list->tracks = malloc(sizeof(SpotifyTrack) * count);
+    SpotifyTrackList *list = spotify_mem_alloc(sizeof(SpotifyTrackList));
+    list->tracks = spotify_mem_alloc(sizeof(SpotifyTrack) * count);
     list->count = count;
 
     struct json_object *total_obj;
@@ -91,80 +91,110 @@ SpotifyTrack* spotify_get_track(SpotifyToken *token, const char *track_id, const
 }
 
 /**
- * Get detailed information about multiple tracks (max 50)
+ * Get detailed information about multiple tracks
+ * More than 50 IDs are split into chunks fetched concurrently
  * 
  * @param token - Valid Spotify token
  * @param track_ids - Array of Spotify track IDs
- * @param count - Number of track IDs (max 50)
+ * @param count - Number of track IDs
  * @param market - Optional: ISO 3166-1 alpha-2 country code (NULL for no market filter)
  * @return SpotifyTrackList or NULL on error
  */
 SpotifyTrackList* spotify_get_tracks(SpotifyToken *token, const char **track_ids, int count, const char *market) {
-    if (!token || !track_ids || count <= 0 || count > 50) {
-        fprintf(stderr, "Invalid parameters (max 50 tracks)\n");
+    if (!token || !track_ids || count <= 0) {
+        fprintf(stderr, "Invalid parameters for get_tracks\n");
         return NULL;
     }
 
-    // Build URL with query parameters
-    char url[2048] = "https://api.spotify.com/v1/tracks?ids=";
-    
-    for (int i = 0; i < count; i++) {
-        if (i > 0) strcat(url, ",");
-        strcat(url, track_ids[i]);
+    int chunks = (count + SPOTIFY_MAX_LIMIT_TRACKS - 1) / SPOTIFY_MAX_LIMIT_TRACKS;
+
+    char (*urls)[2048] = malloc(sizeof(*urls) * chunks);
+    SpotifyRequest *requests = calloc(chunks, sizeof(SpotifyRequest));
+    SpotifyResponse *responses = calloc(chunks, sizeof(SpotifyResponse));
+    if (!urls || !requests || !responses) {
+        free(urls);
+        free(requests);
+        free(responses);
+        return NULL;
     }
 
-    // Add market parameter if provided
-    if (market) {
-        strcat(url, "&market=");
-        strcat(url, market);
+    // Build one URL with query parameters per chunk
+    for (int c = 0; c < chunks; c++) {
+        int first = c * SPOTIFY_MAX_LIMIT_TRACKS;
+        int n = count - first < SPOTIFY_MAX_LIMIT_TRACKS ? count - first : SPOTIFY_MAX_LIMIT_TRACKS;
+
+        spotify_build_ids_url(urls[c], sizeof(urls[c]), ENDPOINT_TRACKS, &track_ids[first], n);
+
+        // Add market parameter if provided
+        if (market) {
+            strncat(urls[c], "&market=", sizeof(urls[c]) - strlen(urls[c]) - 1);
+            strncat(urls[c], market, sizeof(urls[c]) - strlen(urls[c]) - 1);
+        }
+
+        requests[c].method = SPOTIFY_METHOD_GET;
+        requests[c].url = urls[c];
+        requests[c].sink = SPOTIFY_SINK_JSON;
     }
 
-    struct json_object *root = spotify_api_get(token, url);
-    if (!root) {
+    SpotifyTrackList *list = NULL;
+    int succeeded = spotify_request_batch(token, requests, chunks, responses, NULL, NULL, NULL);
+    if (succeeded != chunks) {
         fprintf(stderr, "Failed to get tracks\n");
-        return NULL;
+        goto cleanup;
     }
 
-    struct json_object *tracks_array;
-    if (!json_object_object_get_ex(root, "tracks", &tracks_array)) {
-        fprintf(stderr, "No 'tracks' field in response\n");
-        json_object_put(root);
-        return NULL;
+    int actual_count = 0;
+    for (int c = 0; c < chunks; c++) {
+        struct json_object *tracks_array;
+        if (!responses[c].json ||
+            !json_object_object_get_ex(responses[c].json, "tracks", &tracks_array)) {
+            fprintf(stderr, "No 'tracks' field in response\n");
+            goto cleanup;
+        }
+        actual_count += json_object_array_length(tracks_array);
     }
 
-    int actual_count = json_object_array_length(tracks_array);
-    
-    SpotifyTrackList *list = malloc(sizeof(SpotifyTrackList));
-    if (!list) {
-        json_object_put(root);
-        return NULL;
-    }
+    list = malloc(sizeof(SpotifyTrackList));
+    if (!list) goto cleanup;
 
     list->tracks = malloc(sizeof(SpotifyTrack) * actual_count);
     if (!list->tracks) {
         free(list);
-        json_object_put(root);
-        return NULL;
+        list = NULL;
+        goto cleanup;
     }
 
     list->count = actual_count;
     list->total = actual_count;
 
-    for (int i = 0; i < actual_count; i++) {
-        struct json_object *item = json_object_array_get_idx(tracks_array, i);
-        
-        // Handle null entries (invalid IDs or unavailable tracks)
-        if (item && json_object_get_type(item) != json_type_null) {
-            parse_track_json(item, &list->tracks[i]);
-        } else {
-            // Initialize empty track for null entries
-            memset(&list->tracks[i], 0, sizeof(SpotifyTrack));
-            snprintf(list->tracks[i].name, sizeof(list->tracks[i].name), 
-                     "[Unavailable Track]");
+    int index = 0;
+    for (int c = 0; c < chunks; c++) {
+        struct json_object *tracks_array;
+        json_object_object_get_ex(responses[c].json, "tracks", &tracks_array);
+        int n = json_object_array_length(tracks_array);
+
+        for (int i = 0; i < n; i++, index++) {
+            struct json_object *item = json_object_array_get_idx(tracks_array, i);
+
+            // Handle null entries (invalid IDs or unavailable tracks)
+            if (item && json_object_get_type(item) != json_type_null) {
+                parse_track_json(item, &list->tracks[index]);
+            } else {
+                // Initialize empty track for null entries
+                memset(&list->tracks[index], 0, sizeof(SpotifyTrack));
+                snprintf(list->tracks[index].name, sizeof(list->tracks[index].name),
+                         "[Unavailable Track]");
+            }
         }
     }
 
-    json_object_put(root);
+cleanup:
+    for (int c = 0; c < chunks; c++) {
+        spotify_response_free(&responses[c]);
+    }
+    free(responses);
+    free(requests);
+    free(urls);
     return list;
 }
 
@@ -216,6 +246,37 @@ SpotifyTrackList* spotify_get_saved_tracks(SpotifyToken *token, int limit, int o
     return list;
 }
 
+/**
+ * Get every saved track of the current user
+ * Reads total from the first page and fetches the remaining pages concurrently
+ * 
+ * @param token - Valid Spotify token
+ * @return SpotifyTrackList with all saved tracks, or NULL on error
+ */
+SpotifyTrackList* spotify_get_all_saved_tracks(SpotifyToken *token) {
+    SpotifyTrackList *list = spotify_get_saved_tracks(token, SPOTIFY_MAX_LIMIT_TRACKS, 0);
+    if (!list || list->count >= list->total) return list;
+
+    int page_count = 0;
+    SpotifyResponse *pages = spotify_fetch_pages(token, ENDPOINT_USER_TRACKS,
+                                                 SPOTIFY_MAX_LIMIT_TRACKS, list->count,
+                                                 list->total, SPOTIFY_LISTING_SINK, &page_count);
+    if (!pages) {
+        spotify_free_track_list(list);
+        return NULL;
+    }
+
+    bool ok = spotify_append_track_pages(&list->tracks, &list->count, pages, page_count, "track");
+    spotify_free_pages(pages, page_count);
+
+    if (!ok) {
+        spotify_free_track_list(list);
+        return NULL;
+    }
+
+    return list;
+}
+
 /**
  * Save tracks to current user's 'Your Music' library
  * 
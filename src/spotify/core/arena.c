@@ -0,0 +1,286 @@
+#include "spotify/spotify_internal.h"
+#include "spotify/arena.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <stdatomic.h>
+
+#define ARENA_DEFAULT_BLOCK_SIZE (64 * 1024)
+
+typedef struct ArenaBlock {
+    struct ArenaBlock *next;
+    size_t size;
+    size_t used;
+    max_align_t data[];
+} ArenaBlock;
+
+// Every allocation is preceded by its capacity so it can be grown with spotify_mem_realloc()
+typedef union {
+    size_t size;
+    max_align_t align;
+} ArenaHeader;
+
+struct SpotifyArena {
+    ArenaBlock *blocks;         // Most recent block first
+    size_t block_size;
+    size_t used;
+    const unsigned char *low;   // Address range spanned by the blocks, to rule out
+    const unsigned char *high;  // most foreign pointers without walking them
+    SpotifyArena *next_live;
+};
+
+// Live arenas, so spotify_mem_free() can tell arena memory from heap memory
+// The lock also covers block->used, which arena_owner() reads from other threads
+static SpotifyArena *live_arenas = NULL;
+static pthread_mutex_t live_lock = PTHREAD_MUTEX_INITIALIZER;
+static atomic_int live_count = 0;   // Lets frees skip the lock when no arena exists
+
+static __thread SpotifyArena *current_arena = NULL;
+
+// ===== BLOCKS =====
+
+static ArenaBlock* block_new(size_t size) {
+    ArenaBlock *block = malloc(sizeof(ArenaBlock) + size);
+    if (!block) return NULL;
+
+    block->next = NULL;
+    block->size = size;
+    block->used = 0;
+    return block;
+}
+
+static size_t align_up(size_t size) {
+    size_t align = sizeof(max_align_t);
+    return (size + align - 1) & ~(align - 1);
+}
+
+static void* arena_alloc(SpotifyArena *arena, size_t size) {
+    size_t needed = sizeof(ArenaHeader) + align_up(size);
+    ArenaBlock *block = arena->blocks;
+
+    if (!block || block->size - block->used < needed) {
+        // Oversized requests get a dedicated block
+        size_t block_size = needed > arena->block_size ? needed : arena->block_size;
+        ArenaBlock *fresh = block_new(block_size);
+        if (!fresh) return NULL;
+
+        const unsigned char *start = (const unsigned char *)fresh->data;
+        pthread_mutex_lock(&live_lock);
+        fresh->next = arena->blocks;
+        arena->blocks = fresh;
+        if (!arena->low || start < arena->low) arena->low = start;
+        if (start + block_size > arena->high) arena->high = start + block_size;
+        pthread_mutex_unlock(&live_lock);
+
+        block = fresh;
+    }
+
+    ArenaHeader *header = (ArenaHeader *)((unsigned char *)block->data + block->used);
+    header->size = size;
+
+    pthread_mutex_lock(&live_lock);
+    block->used += needed;
+    pthread_mutex_unlock(&live_lock);
+    arena->used += size;
+
+    return header + 1;
+}
+
+static bool block_contains(const ArenaBlock *block, const void *ptr) {
+    const unsigned char *start = (const unsigned char *)block->data;
+    const unsigned char *p = ptr;
+    return p >= start && p < start + block->used;
+}
+
+/**
+ * Find the live arena that handed out ptr, or NULL for heap memory
+ * Arenas whose address range excludes ptr are skipped without walking their blocks
+ */
+static SpotifyArena* arena_owner(const void *ptr) {
+    if (atomic_load(&live_count) == 0) return NULL;
+
+    const unsigned char *p = ptr;
+    SpotifyArena *owner = NULL;
+
+    pthread_mutex_lock(&live_lock);
+    for (SpotifyArena *arena = live_arenas; arena && !owner; arena = arena->next_live) {
+        if (p < arena->low || p >= arena->high) continue;
+
+        for (ArenaBlock *block = arena->blocks; block; block = block->next) {
+            if (block_contains(block, ptr)) {
+                owner = arena;
+                break;
+            }
+        }
+    }
+    pthread_mutex_unlock(&live_lock);
+
+    return owner;
+}
+
+/**
+ * Grow ptr in place when it is the last allocation of the arena's current block
+ * Only for the calling thread's active arena, the one no other thread bumps
+ */
+static bool arena_extend(SpotifyArena *arena, void *ptr, size_t size) {
+    ArenaBlock *block = arena->blocks;
+    ArenaHeader *header = (ArenaHeader *)ptr - 1;
+    unsigned char *end = (unsigned char *)ptr + align_up(header->size);
+
+    if (arena != current_arena || !block || !block_contains(block, ptr) ||
+        end != (unsigned char *)block->data + block->used) {
+        return false;
+    }
+
+    size_t grow = align_up(size) - align_up(header->size);
+    if (block->size - block->used < grow) return false;
+
+    pthread_mutex_lock(&live_lock);
+    block->used += grow;
+    pthread_mutex_unlock(&live_lock);
+    arena->used += size - header->size;
+    header->size = size;
+    return true;
+}
+
+// ===== PUBLIC FUNCTIONS =====
+
+SpotifyArena* spotify_arena_new(size_t block_size) {
+    SpotifyArena *arena = calloc(1, sizeof(SpotifyArena));
+    if (!arena) return NULL;
+
+    arena->block_size = block_size ? block_size : ARENA_DEFAULT_BLOCK_SIZE;
+
+    pthread_mutex_lock(&live_lock);
+    arena->next_live = live_arenas;
+    live_arenas = arena;
+    atomic_fetch_add(&live_count, 1);
+    pthread_mutex_unlock(&live_lock);
+
+    return arena;
+}
+
+void spotify_arena_reset(SpotifyArena *arena) {
+    if (!arena) return;
+
+    pthread_mutex_lock(&live_lock);
+
+    // Keep the oldest (regular sized) block, drop the rest
+    ArenaBlock *keep = NULL;
+    ArenaBlock *block = arena->blocks;
+    while (block) {
+        ArenaBlock *next = block->next;
+        if (!next && block->size == arena->block_size) {
+            keep = block;
+        } else {
+            free(block);
+        }
+        block = next;
+    }
+
+    if (keep) keep->used = 0;
+    arena->blocks = keep;
+    arena->used = 0;
+    arena->low = keep ? (const unsigned char *)keep->data : NULL;
+    arena->high = keep ? arena->low + keep->size : NULL;
+
+    pthread_mutex_unlock(&live_lock);
+}
+
+void spotify_arena_free(SpotifyArena *arena) {
+    if (!arena) return;
+
+    if (current_arena == arena) current_arena = NULL;
+
+    pthread_mutex_lock(&live_lock);
+    for (SpotifyArena **link = &live_arenas; *link; link = &(*link)->next_live) {
+        if (*link == arena) {
+            *link = arena->next_live;
+            atomic_fetch_sub(&live_count, 1);
+            break;
+        }
+    }
+
+    ArenaBlock *block = arena->blocks;
+    while (block) {
+        ArenaBlock *next = block->next;
+        free(block);
+        block = next;
+    }
+    pthread_mutex_unlock(&live_lock);
+
+    free(arena);
+}
+
+SpotifyArena* spotify_arena_begin(SpotifyArena *arena) {
+    SpotifyArena *previous = current_arena;
+    current_arena = arena;
+    return previous;
+}
+
+void spotify_arena_end(SpotifyArena *previous) {
+    current_arena = previous;
+}
+
+size_t spotify_arena_used(const SpotifyArena *arena) {
+    return arena ? arena->used : 0;
+}
+
+// ===== ALLOCATION HELPERS =====
+
+/**
+ * malloc(), or the active arena of the calling thread when there is one
+ */
+void* spotify_mem_alloc(size_t size) {
+    if (current_arena) return arena_alloc(current_arena, size);
+    return malloc(size);
+}
+
+void* spotify_mem_calloc(size_t count, size_t size) {
+    if (size && count > SIZE_MAX / size) return NULL;
+
+    if (current_arena) {
+        void *ptr = arena_alloc(current_arena, count * size);
+        if (ptr) memset(ptr, 0, count * size);
+        return ptr;
+    }
+    return calloc(count, size);
+}
+
+/**
+ * realloc() that also accepts arena memory
+ * Arena allocations grow in place when they are the last one of their block,
+ * otherwise they move to a new allocation (in the active arena, or on the
+ * heap) of at least twice their capacity, so growing an array one page at a
+ * time copies it O(log n) times instead of once per page
+ */
+void* spotify_mem_realloc(void *ptr, size_t size) {
+    if (!ptr) return spotify_mem_alloc(size);
+
+    SpotifyArena *owner = arena_owner(ptr);
+    if (!owner) return realloc(ptr, size);
+
+    size_t old_size = ((ArenaHeader *)ptr - 1)->size;
+    if (size <= old_size) return ptr;
+    if (arena_extend(owner, ptr, size)) return ptr;
+
+    size_t capacity = old_size <= SIZE_MAX / 2 && old_size * 2 > size ? old_size * 2 : size;
+
+    void *moved = spotify_mem_alloc(capacity);
+    if (!moved) return NULL;
+
+    memcpy(moved, ptr, old_size);
+    return moved;
+}
+
+/**
+ * free() for memory from spotify_mem_alloc(); arena memory is left to its arena
+ */
+void spotify_mem_free(void *ptr) {
+    if (!ptr) return;
+    if (arena_owner(ptr)) return;
+    free(ptr);
+}
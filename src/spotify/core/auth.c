@@ -2,7 +2,14 @@
 #include <string.h>
 #include <stdlib.h>
 
+/**
+ * Get the current user's id (GET /me, memoized for the session)
+ * Returns allocated string that must be freed by caller
+ */
 char* spotify_get_current_user_id(SpotifyToken *token) {
+    char memo[64];
+    if (spotify_session_user_id(token, memo, sizeof(memo))) return strdup(memo);
+
     const char *url = "https://api.spotify.com/v1/me";
 
     struct json_object *root = spotify_api_get(token, url);
@@ -17,5 +24,7 @@ char* spotify_get_current_user_id(SpotifyToken *token) {
     char *user_id = strdup(json_object_get_string(id_obj));
     json_object_put(root);
 
+    if (user_id) spotify_session_store_user_id(token, user_id);
+
     return user_id;
 }
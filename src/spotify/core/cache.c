@@ -0,0 +1,312 @@
+#include "spotify/spotify_internal.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <pthread.h>
+#include <errno.h>
+
+#define CACHE_MAGIC "SPOTCLI-CACHE 2"
+
+/**
+ * On-disk HTTP cache for GET responses
+ *
+ * One file per account+method+URL under ~/.config/spotCLI/cache:
+ *   SPOTCLI-CACHE 2
+ *   <expires, unix time>
+ *   <etag, may be empty>
+ *   <account> <url>
+ *   <body>
+ *
+ * Responses under /me differ per account, so every entry belongs to the
+ * account whose token fetched it. Responses marked private are not stored.
+ */
+struct SpotifyCacheEntry {
+    time_t expires;
+    char etag[SPOTIFY_ETAG_SIZE];
+    char *body;
+    size_t body_size;
+};
+
+/**
+ * Build ~/.config/spotCLI/<name> into path, creating missing directories
+ * Returns false if HOME is not set or the directory cannot be created
+ */
+bool spotify_config_subdir(const char *name, char *path, size_t size) {
+    const char *home = getenv("HOME");
+    if (!home) return false;
+
+    int len = snprintf(path, size, "%s/%s/%s", home, TOKEN_DIR, name);
+    if (len < 0 || (size_t)len >= size) return false;
+
+    // mkdir -p, one component at a time
+    for (char *slash = strchr(path + strlen(home) + 1, '/'); slash; slash = strchr(slash + 1, '/')) {
+        *slash = '\0';
+        mkdir(path, 0700);
+        *slash = '/';
+    }
+
+    return mkdir(path, 0700) == 0 || errno == EEXIST;
+}
+
+static bool cache_enabled = true;
+static pthread_once_t cache_once = PTHREAD_ONCE_INIT;
+static char cache_dir[512];
+
+static void cache_init(void) {
+    if (getenv("SPOTCLI_NO_CACHE")) {
+        cache_enabled = false;
+        return;
+    }
+
+    if (!spotify_config_subdir("cache", cache_dir, sizeof(cache_dir))) {
+        cache_dir[0] = '\0';
+        cache_enabled = false;
+    }
+}
+
+static bool cache_active(void) {
+    pthread_once(&cache_once, cache_init);
+    return cache_enabled;
+}
+
+static bool cacheable(const SpotifyRequest *request) {
+    return request->method == SPOTIFY_METHOD_GET && !request->bypass_cache &&
+           (request->sink == SPOTIFY_SINK_JSON || request->sink == SPOTIFY_SINK_BUFFER);
+}
+
+static uint64_t fnv1a(uint64_t hash, const char *text) {
+    for (const unsigned char *p = (const unsigned char *)text; *p; p++) {
+        hash ^= *p;
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+/**
+ * Cache key of token's account: a hash of its refresh token (or access
+ * token), so entries never leave the account that fetched them
+ */
+unsigned long long spotify_cache_account(const SpotifyToken *token) {
+    const char *account = token->refresh_token[0] ? token->refresh_token : token->access_token;
+    return fnv1a(14695981039346656037ULL, account);
+}
+
+// FNV-1a over "ACCOUNT METHOD URL"
+static void cache_path(const SpotifyRequest *request, const SpotifyResponse *response,
+                       char *path, size_t size) {
+    char account[32];
+    snprintf(account, sizeof(account), "%016llx ", response->account);
+
+    uint64_t hash = fnv1a(14695981039346656037ULL, account);
+    hash = fnv1a(hash, spotify_method_name(request->method));
+    hash = fnv1a(hash, " ");
+    hash = fnv1a(hash, request->url);
+
+    snprintf(path, size, "%s/%016llx", cache_dir, (unsigned long long)hash);
+}
+
+static void strip_newline(char *line) {
+    line[strcspn(line, "\r\n")] = '\0';
+}
+
+static SpotifyCacheEntry* cache_read(const SpotifyRequest *request, const SpotifyResponse *response) {
+    char path[640];
+    cache_path(request, response, path, sizeof(path));
+
+    FILE *f = fopen(path, "rb");
+    if (!f) return NULL;
+
+    SpotifyCacheEntry *entry = calloc(1, sizeof(SpotifyCacheEntry));
+    char line[2048];
+    bool valid = entry != NULL;
+
+    // Header
+    valid = valid && fgets(line, sizeof(line), f) && strncmp(line, CACHE_MAGIC, strlen(CACHE_MAGIC)) == 0;
+    valid = valid && fgets(line, sizeof(line), f);
+    if (valid) entry->expires = (time_t)strtoll(line, NULL, 10);
+    valid = valid && fgets(line, sizeof(line), f);
+    if (valid) {
+        strip_newline(line);
+        snprintf(entry->etag, sizeof(entry->etag), "%s", line);
+    }
+
+    // Account and URL guard against hash collisions
+    valid = valid && fgets(line, sizeof(line), f);
+    if (valid) {
+        strip_newline(line);
+        char *url = NULL;
+        valid = strtoull(line, &url, 16) == response->account && *url == ' ' &&
+                strcmp(url + 1, request->url) == 0;
+    }
+
+    // Body is the rest of the file
+    if (valid) {
+        long start = ftell(f);
+        fseek(f, 0, SEEK_END);
+        long end = ftell(f);
+        fseek(f, start, SEEK_SET);
+
+        entry->body_size = end > start ? (size_t)(end - start) : 0;
+        entry->body = malloc(entry->body_size + 1);
+        valid = entry->body && fread(entry->body, 1, entry->body_size, f) == entry->body_size;
+        if (valid) entry->body[entry->body_size] = '\0';
+    }
+
+    fclose(f);
+
+    if (!valid) {
+        spotify_cache_entry_free(entry);
+        return NULL;
+    }
+    return entry;
+}
+
+/**
+ * Write an entry atomically (temporary file + rename)
+ */
+static void cache_write(const SpotifyRequest *request, const SpotifyResponse *response,
+                        time_t expires, const char *etag, const char *body, size_t body_size) {
+    static unsigned long counter = 0;
+
+    char path[640];
+    char tmp_path[704];
+    cache_path(request, response, path, sizeof(path));
+    snprintf(tmp_path, sizeof(tmp_path), "%s.%ld.%lu", path, (long)getpid(),
+             __sync_fetch_and_add(&counter, 1));
+
+    FILE *f = fopen(tmp_path, "wb");
+    if (!f) return;
+
+    fprintf(f, CACHE_MAGIC "\n%lld\n%s\n%016llx %s\n", (long long)expires, etag ? etag : "",
+            response->account, request->url);
+    bool ok = fwrite(body, 1, body_size, f) == body_size;
+    ok = fclose(f) == 0 && ok;
+
+    if (!ok || rename(tmp_path, path) != 0) {
+        unlink(tmp_path);
+    }
+}
+
+// Turn a cached body into what the request's sink would have produced
+static bool cache_fill(const SpotifyRequest *request, SpotifyResponse *response,
+                       const SpotifyCacheEntry *entry) {
+    response->status = 200;
+    response->body_size = entry->body_size;
+
+    if (request->sink == SPOTIFY_SINK_JSON) {
+        response->json = json_tokener_parse(entry->body);
+        return response->json != NULL;
+    }
+
+    response->body = malloc(entry->body_size + 1);
+    if (!response->body) return false;
+    memcpy(response->body, entry->body, entry->body_size + 1);
+    return true;
+}
+
+// ===== ENGINE HOOKS =====
+
+/**
+ * Look up a request before it is sent
+ * Returns true when a fresh entry was copied into response (no transfer needed).
+ * A stale entry with an ETag is attached to response so the request is sent
+ * as a conditional GET.
+ */
+bool spotify_cache_lookup(const SpotifyRequest *request, SpotifyResponse *response) {
+    if (!cacheable(request) || !cache_active()) return false;
+    if (response->client && response->client->cache_disabled) return false;
+
+    SpotifyCacheEntry *entry = cache_read(request, response);
+    if (!entry) return false;
+
+    if (entry->expires > time(NULL)) {
+        bool served = cache_fill(request, response, entry);
+        spotify_cache_entry_free(entry);
+        if (served) {
+            if (response->client) spotify_limiter_cache_hit(response->client->limiter);
+            return true;
+        }
+
+        spotify_response_reset(response);
+        return false;
+    }
+
+    if (entry->etag[0] == '\0') {
+        spotify_cache_entry_free(entry);
+        return false;
+    }
+
+    response->cache_entry = entry;
+    return false;
+}
+
+/**
+ * ETag of the stale entry attached by spotify_cache_lookup(), or NULL
+ */
+const char* spotify_cache_etag(const SpotifyResponse *response) {
+    if (!response->cache_entry || response->cache_entry->etag[0] == '\0') return NULL;
+    return response->cache_entry->etag;
+}
+
+/**
+ * Update the cache from a finished transfer
+ * A 304 is answered from the attached entry; a 200 is stored when its headers allow it.
+ * Returns false if a 304 could not be served
+ */
+bool spotify_cache_store(const SpotifyRequest *request, SpotifyResponse *response) {
+    if (!cacheable(request) || !cache_active()) return true;
+    if (response->client && response->client->cache_disabled) return true;
+
+    time_t now = time(NULL);
+    time_t expires = now + (response->max_age > 0 ? response->max_age : 0);
+
+    if (response->status == 304) {
+        SpotifyCacheEntry *entry = response->cache_entry;
+        if (!entry) return false;
+
+        response->cache_entry = NULL;
+        bool served = cache_fill(request, response, entry);
+
+        // Refresh the freshness lifetime sent with the 304
+        if (served && !response->no_store) {
+            const char *etag = response->etag[0] ? response->etag : entry->etag;
+            cache_write(request, response, expires, etag, entry->body, entry->body_size);
+        }
+
+        spotify_cache_entry_free(entry);
+        return served;
+    }
+
+    if (response->status != 200 || response->no_store) return true;
+
+    // Nothing to revalidate with and nothing fresh to serve
+    if (response->etag[0] == '\0' && response->max_age <= 0) return true;
+
+    if (response->body) {
+        cache_write(request, response, expires, response->etag, response->body, response->body_size);
+    } else if (response->json) {
+        const char *body = json_object_to_json_string_ext(response->json, JSON_C_TO_STRING_PLAIN);
+        cache_write(request, response, expires, response->etag, body, strlen(body));
+    }
+
+    return true;
+}
+
+void spotify_cache_entry_free(SpotifyCacheEntry *entry) {
+    if (!entry) return;
+    free(entry->body);
+    free(entry);
+}
+
+/**
+ * Turn the response cache on or off for this process (on by default,
+ * off when SPOTCLI_NO_CACHE is set)
+ */
+void spotify_cache_set_enabled(bool enabled) {
+    pthread_once(&cache_once, cache_init);
+    cache_enabled = enabled && cache_dir[0] != '\0';
+}
@@ -0,0 +1,177 @@
+#include "spotify/spotify_internal.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+/**
+ * Clients own the per-account state of the request layer
+ *
+ * Several clients can be used from the same process, each from any number
+ * of threads: their members are internally locked. The response cache
+ * directory, the rate limiter (the quota belongs to the application's
+ * client id) and the hedge latency samples stay process-wide.
+ */
+
+static SpotifyClient *default_client = NULL;
+static pthread_once_t default_once = PTHREAD_ONCE_INIT;
+
+static bool client_init(SpotifyClient *client, int max_concurrency) {
+    client->token.client = client;
+    client->pool = spotify_pool_new();
+    client->limiter = spotify_limiter_new(max_concurrency);
+    client->session = spotify_session_new();
+    client->refresh = spotify_token_refresh_new();
+    client->player = spotify_player_model_new();
+
+    return client->pool && client->limiter && client->session && client->refresh &&
+           client->player;
+}
+
+static void client_release(SpotifyClient *client) {
+    spotify_token_refresh_free(client->refresh);
+    spotify_pool_free(client->pool);
+    spotify_limiter_free(client->limiter);
+    spotify_session_free(client->session);
+    spotify_player_model_free(client->player);
+    client->pool = NULL;
+    client->limiter = NULL;
+    client->session = NULL;
+    client->refresh = NULL;
+    client->player = NULL;
+}
+
+// Close the default client's connections at exit; its stats stay readable
+// for exit handlers registered before it was created (--stats)
+// The background refresher is joined first: it may be using the pool
+static void default_client_cleanup(void) {
+    spotify_token_refresh_stop(default_client->refresh);
+
+    SpotifyPool *pool = default_client->pool;
+    default_client->pool = NULL;
+    spotify_pool_free(pool);
+}
+
+static void default_client_init(void) {
+    default_client = calloc(1, sizeof(SpotifyClient));
+    if (!default_client) {
+        fprintf(stderr, "Failed to allocate the default client\n");
+        abort();
+    }
+
+    if (!client_init(default_client, 0)) {
+        fprintf(stderr, "Failed to initialize the default client\n");
+        abort();
+    }
+
+    // Tokens without a client share this one, but it does not own any of them
+    default_client->token.client = NULL;
+    atexit(default_client_cleanup);
+}
+
+/**
+ * Client used by tokens that were not created with spotify_client_new()
+ */
+SpotifyClient* spotify_default_client(void) {
+    pthread_once(&default_once, default_client_init);
+    return default_client;
+}
+
+/**
+ * Client the requests of token belong to
+ */
+SpotifyClient* spotify_token_client(const SpotifyToken *token) {
+    if (token && token->client) return token->client;
+    return spotify_default_client();
+}
+
+// ===== PUBLIC FUNCTIONS =====
+
+/**
+ * Create a client and authenticate it
+ *
+ * @param config - Optional settings, NULL for the defaults
+ * @return Client to free with spotify_client_free(), or NULL if the
+ *         client could not be set up or authorized
+ */
+SpotifyClient* spotify_client_new(const SpotifyClientConfig *config) {
+    SpotifyClient *client = calloc(1, sizeof(SpotifyClient));
+    if (!client) return NULL;
+
+    if (config && config->token_path) {
+        snprintf(client->token_path, sizeof(client->token_path), "%s", config->token_path);
+    }
+    client->cache_disabled = config && config->disable_cache;
+
+    if (!client_init(client, config ? config->max_concurrency : 0)) {
+        fprintf(stderr, "Failed to initialize client\n");
+        spotify_client_free(client);
+        return NULL;
+    }
+
+    if (!spotify_get_access_token(&client->token)) {
+        fprintf(stderr, "Failed to authenticate client\n");
+        spotify_client_free(client);
+        return NULL;
+    }
+    spotify_token_keep_fresh(&client->token);
+
+    return client;
+}
+
+/**
+ * Free a client; no request of it may still be running
+ */
+void spotify_client_free(SpotifyClient *client) {
+    if (!client) return;
+
+    client_release(client);
+    free(client);
+}
+
+/**
+ * Token to pass to the API functions to act through client
+ */
+SpotifyToken* spotify_client_token(SpotifyClient *client) {
+    return client ? &client->token : NULL;
+}
+
+void spotify_client_get_stats(SpotifyClient *client, SpotifyRequestStats *stats) {
+    if (!client || !stats) return;
+    spotify_limiter_stats(client->limiter, stats);
+}
+
+/**
+ * Open a connection to api.spotify.com for client (NULL: the default one)
+ *
+ * Sends an unauthenticated HEAD so DNS, TCP and TLS (and HTTP/2 setup) are
+ * done and the connection waits in the pool's share for the first real
+ * request. Meant to run in parallel with loading or refreshing the token.
+ */
+bool spotify_warm_connection(SpotifyClient *client) {
+    SpotifyPool *pool = (client ? client : spotify_default_client())->pool;
+
+    CURL *curl = spotify_pool_acquire(pool);
+    if (!curl) return false;
+
+    curl_easy_setopt(curl, CURLOPT_URL, SPOTIFY_API_BASE "/");
+    curl_easy_setopt(curl, CURLOPT_NOBODY, 1L);
+    curl_easy_setopt(curl, CURLOPT_TIMEOUT_MS, (long)SPOTIFY_CONNECT_TIMEOUT_MS);
+    CURLcode res = curl_easy_perform(curl);
+    spotify_pool_transfer_done(pool, curl, res);
+
+    spotify_pool_release(pool, curl);
+    return res == CURLE_OK;
+}
+
+/**
+ * Stats of the default client (the one --stats reports)
+ */
+void spotify_get_request_stats(SpotifyRequestStats *stats) {
+    if (!stats) return;
+    spotify_limiter_stats(spotify_default_client()->limiter, stats);
+}
+
+void spotify_print_request_stats(void) {
+    spotify_limiter_print(spotify_default_client()->limiter);
+}
@@ -0,0 +1,650 @@
+#include "spotify/spotify_internal.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+
+/**
+ * Zero-DOM parser for the hot listing responses
+ *
+ * Walks the raw response body once and copies only the keys mapped into
+ * SpotifyTrack, SpotifyArtist, SpotifyPlaylist and SpotifyPlayerState straight
+ * into the structs. Every other value is skipped without allocating.
+ * Results match the parse_*_json() functions in parsers.c.
+ */
+
+typedef struct {
+    const char *p;
+    const char *end;
+    bool error;
+} FastScanner;
+
+#define FAST_KEY_SIZE 64
+
+// ===== TOKENIZER =====
+
+static void skip_ws(FastScanner *s) {
+    while (s->p < s->end &&
+           (*s->p == ' ' || *s->p == '\t' || *s->p == '\n' || *s->p == '\r')) {
+        s->p++;
+    }
+}
+
+// Next significant character, or 0 at end of input
+static char peek(FastScanner *s) {
+    skip_ws(s);
+    return s->p < s->end ? *s->p : 0;
+}
+
+static bool expect(FastScanner *s, char c) {
+    if (peek(s) != c) {
+        s->error = true;
+        return false;
+    }
+    s->p++;
+    return true;
+}
+
+static bool match_literal(FastScanner *s, const char *literal) {
+    size_t n = strlen(literal);
+    if ((size_t)(s->end - s->p) < n || memcmp(s->p, literal, n) != 0) {
+        s->error = true;
+        return false;
+    }
+    s->p += n;
+    return true;
+}
+
+static int hex_value(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+static bool read_hex4(FastScanner *s, unsigned *out) {
+    if (s->end - s->p < 4) return false;
+    unsigned v = 0;
+    for (int i = 0; i < 4; i++) {
+        int h = hex_value(s->p[i]);
+        if (h < 0) return false;
+        v = (v << 4) | (unsigned)h;
+    }
+    s->p += 4;
+    *out = v;
+    return true;
+}
+
+// Append one byte, silently truncating like strncpy(dst, src, size - 1)
+static void put_byte(char *dst, size_t size, size_t *len, char c) {
+    if (dst && *len + 1 < size) {
+        dst[(*len)++] = c;
+    }
+}
+
+static void put_utf8(char *dst, size_t size, size_t *len, unsigned cp) {
+    if (cp < 0x80) {
+        put_byte(dst, size, len, (char)cp);
+    } else if (cp < 0x800) {
+        put_byte(dst, size, len, (char)(0xC0 | (cp >> 6)));
+        put_byte(dst, size, len, (char)(0x80 | (cp & 0x3F)));
+    } else if (cp < 0x10000) {
+        put_byte(dst, size, len, (char)(0xE0 | (cp >> 12)));
+        put_byte(dst, size, len, (char)(0x80 | ((cp >> 6) & 0x3F)));
+        put_byte(dst, size, len, (char)(0x80 | (cp & 0x3F)));
+    } else {
+        put_byte(dst, size, len, (char)(0xF0 | (cp >> 18)));
+        put_byte(dst, size, len, (char)(0x80 | ((cp >> 12) & 0x3F)));
+        put_byte(dst, size, len, (char)(0x80 | ((cp >> 6) & 0x3F)));
+        put_byte(dst, size, len, (char)(0x80 | (cp & 0x3F)));
+    }
+}
+
+/**
+ * Read a string value, decoding escapes into dst (NUL-terminated, truncated to size)
+ * dst may be NULL to skip the string
+ */
+static bool scan_string(FastScanner *s, char *dst, size_t size) {
+    if (!expect(s, '"')) return false;
+
+    size_t len = 0;
+    while (s->p < s->end) {
+        char c = *s->p++;
+
+        if (c == '"') {
+            if (dst && size > 0) dst[len] = '\0';
+            return true;
+        }
+
+        if (c != '\\') {
+            put_byte(dst, size, &len, c);
+            continue;
+        }
+
+        if (s->p >= s->end) break;
+        c = *s->p++;
+
+        switch (c) {
+            case '"':  put_byte(dst, size, &len, '"');  break;
+            case '\\': put_byte(dst, size, &len, '\\'); break;
+            case '/':  put_byte(dst, size, &len, '/');  break;
+            case 'b':  put_byte(dst, size, &len, '\b'); break;
+            case 'f':  put_byte(dst, size, &len, '\f'); break;
+            case 'n':  put_byte(dst, size, &len, '\n'); break;
+            case 'r':  put_byte(dst, size, &len, '\r'); break;
+            case 't':  put_byte(dst, size, &len, '\t'); break;
+            case 'u': {
+                unsigned cp;
+                if (!read_hex4(s, &cp)) goto fail;
+
+                // Surrogate pair
+                if (cp >= 0xD800 && cp <= 0xDBFF &&
+                    s->end - s->p >= 6 && s->p[0] == '\\' && s->p[1] == 'u') {
+                    const char *save = s->p;
+                    unsigned low;
+                    s->p += 2;
+                    if (read_hex4(s, &low) && low >= 0xDC00 && low <= 0xDFFF) {
+                        cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+                    } else {
+                        s->p = save;
+                    }
+                }
+
+                put_utf8(dst, size, &len, cp);
+                break;
+            }
+            default:
+                goto fail;
+        }
+    }
+
+fail:
+    s->error = true;
+    return false;
+}
+
+/**
+ * Read a number; integers outside the int range are clamped and
+ * fractions truncated, matching json_object_get_int()
+ */
+static bool scan_number(FastScanner *s, int *out) {
+    skip_ws(s);
+
+    const char *start = s->p;
+    bool is_float = false;
+    while (s->p < s->end) {
+        char c = *s->p;
+        if (c == '.' || c == 'e' || c == 'E') {
+            is_float = true;
+        } else if (!(c == '-' || c == '+' || (c >= '0' && c <= '9'))) {
+            break;
+        }
+        s->p++;
+    }
+
+    size_t n = (size_t)(s->p - start);
+    char digits[64];
+    if (n == 0 || n >= sizeof(digits)) {
+        s->error = true;
+        return false;
+    }
+    memcpy(digits, start, n);
+    digits[n] = '\0';
+
+    if (is_float) {
+        double d = strtod(digits, NULL);
+        if (d >= (double)INT_MAX) *out = INT_MAX;
+        else if (d <= (double)INT_MIN) *out = INT_MIN;
+        else *out = (int)d;
+    } else {
+        long long v = strtoll(digits, NULL, 10);
+        if (v > INT_MAX) *out = INT_MAX;
+        else if (v < INT_MIN) *out = INT_MIN;
+        else *out = (int)v;
+    }
+
+    return true;
+}
+
+static bool skip_value(FastScanner *s);
+
+static bool skip_container(FastScanner *s, char open, char close) {
+    if (!expect(s, open)) return false;
+
+    if (peek(s) == close) {
+        s->p++;
+        return true;
+    }
+
+    for (;;) {
+        if (open == '{') {
+            if (!scan_string(s, NULL, 0) || !expect(s, ':')) return false;
+        }
+        if (!skip_value(s)) return false;
+
+        char c = peek(s);
+        if (c != close && c != ',') {
+            s->error = true;
+            return false;
+        }
+        s->p++;
+        if (c == close) return true;
+    }
+}
+
+static bool skip_value(FastScanner *s) {
+    switch (peek(s)) {
+        case '{': return skip_container(s, '{', '}');
+        case '[': return skip_container(s, '[', ']');
+        case '"': return scan_string(s, NULL, 0);
+        case 't': return match_literal(s, "true");
+        case 'f': return match_literal(s, "false");
+        case 'n': return match_literal(s, "null");
+        case 0:
+            s->error = true;
+            return false;
+        default: {
+            int ignored;
+            return scan_number(s, &ignored);
+        }
+    }
+}
+
+/**
+ * Consume "null" if it is the next value
+ */
+static bool skip_null(FastScanner *s) {
+    if (peek(s) != 'n') return false;
+    return match_literal(s, "null");
+}
+
+/**
+ * Iterate the members of an object
+ * Call with first = true right after the opening brace; returns false at the
+ * closing brace (consumed) or on error
+ */
+static bool next_key(FastScanner *s, bool *first, char *key, size_t size) {
+    if (s->error) return false;
+
+    char c = peek(s);
+
+    if (c == '}') {
+        s->p++;
+        return false;
+    }
+
+    if (!*first) {
+        if (!expect(s, ',')) return false;
+    }
+    *first = false;
+
+    return scan_string(s, key, size) && expect(s, ':');
+}
+
+/**
+ * Iterate the elements of an array, same contract as next_key()
+ */
+static bool next_element(FastScanner *s, bool *first) {
+    if (s->error) return false;
+
+    char c = peek(s);
+
+    if (c == ']') {
+        s->p++;
+        return false;
+    }
+
+    if (!*first) {
+        if (!expect(s, ',')) return false;
+    }
+    *first = false;
+
+    return true;
+}
+
+// ===== FIELD HELPERS =====
+
+// String field; null and non-string values leave dst empty
+static void field_string(FastScanner *s, char *dst, size_t size) {
+    if (peek(s) == '"') {
+        scan_string(s, dst, size);
+    } else {
+        skip_value(s);
+    }
+}
+
+static void field_int(FastScanner *s, int *dst) {
+    char c = peek(s);
+    if (c == '-' || (c >= '0' && c <= '9')) {
+        scan_number(s, dst);
+    } else {
+        skip_value(s);
+    }
+}
+
+static void field_bool(FastScanner *s, bool *dst) {
+    char c = peek(s);
+    if (c == 't') {
+        if (match_literal(s, "true")) *dst = true;
+    } else if (c == 'f') {
+        if (match_literal(s, "false")) *dst = false;
+    } else {
+        skip_value(s);
+    }
+}
+
+// Read one key of a nested object ({"name": ...}, {"total": ...}) and skip the rest
+static void field_nested_string(FastScanner *s, const char *wanted, char *dst, size_t size) {
+    if (skip_null(s) || !expect(s, '{')) return;
+
+    char key[FAST_KEY_SIZE];
+    bool first = true;
+    while (next_key(s, &first, key, sizeof(key))) {
+        if (strcmp(key, wanted) == 0) field_string(s, dst, size);
+        else skip_value(s);
+    }
+}
+
+static void field_nested_int(FastScanner *s, const char *wanted, int *dst) {
+    if (skip_null(s) || !expect(s, '{')) return;
+
+    char key[FAST_KEY_SIZE];
+    bool first = true;
+    while (next_key(s, &first, key, sizeof(key))) {
+        if (strcmp(key, wanted) == 0) field_int(s, dst);
+        else skip_value(s);
+    }
+}
+
+// Read one key of the first object of an array ([{"name": ...}, ...]) and skip the rest
+static void field_first_string(FastScanner *s, const char *wanted, char *dst, size_t size) {
+    if (skip_null(s) || !expect(s, '[')) return;
+
+    bool first = true;
+    bool taken = false;
+    while (next_element(s, &first)) {
+        if (taken) {
+            skip_value(s);
+        } else {
+            field_nested_string(s, wanted, dst, size);
+            taken = true;
+        }
+        if (s->error) return;
+    }
+}
+
+// Join the first max strings of an array with ", " ({"genres": ["a", "b"]} -> "a, b")
+static void field_string_list(FastScanner *s, int max, char *dst, size_t size) {
+    if (skip_null(s) || !expect(s, '[')) return;
+
+    size_t len = strlen(dst);
+    bool first = true;
+    int taken = 0;
+    while (next_element(s, &first)) {
+        if (taken >= max) {
+            skip_value(s);
+        } else {
+            char item[256] = "";
+            field_string(s, item, sizeof(item));
+            for (const char *p = taken > 0 ? ", " : ""; *p; p++) put_byte(dst, size, &len, *p);
+            for (const char *p = item; *p; p++) put_byte(dst, size, &len, *p);
+            taken++;
+        }
+        if (s->error) return;
+    }
+    if (size > 0) dst[len] = '\0';
+}
+
+// ===== OBJECT MAPPERS =====
+
+static void scan_track(FastScanner *s, SpotifyTrack *track) {
+    memset(track, 0, sizeof(SpotifyTrack));
+    if (skip_null(s) || !expect(s, '{')) return;
+
+    char key[FAST_KEY_SIZE];
+    bool first = true;
+    while (next_key(s, &first, key, sizeof(key))) {
+        if (strcmp(key, "id") == 0) field_string(s, track->id, sizeof(track->id));
+        else if (strcmp(key, "name") == 0) field_string(s, track->name, sizeof(track->name));
+        else if (strcmp(key, "uri") == 0) field_string(s, track->uri, sizeof(track->uri));
+        else if (strcmp(key, "duration_ms") == 0) field_int(s, &track->duration_ms);
+        else if (strcmp(key, "artists") == 0) field_first_string(s, "name", track->artist, sizeof(track->artist));
+        else if (strcmp(key, "album") == 0) field_nested_string(s, "name", track->album, sizeof(track->album));
+        else skip_value(s);
+    }
+}
+
+// Playlist and saved-track items wrap the track: {"added_at": ..., "track": {...}}
+static void scan_wrapped_track(FastScanner *s, const char *wrapper, SpotifyTrack *track) {
+    memset(track, 0, sizeof(SpotifyTrack));
+    if (skip_null(s) || !expect(s, '{')) return;
+
+    char key[FAST_KEY_SIZE];
+    bool first = true;
+    while (next_key(s, &first, key, sizeof(key))) {
+        if (strcmp(key, wrapper) == 0) scan_track(s, track);
+        else skip_value(s);
+    }
+}
+
+static void scan_artist(FastScanner *s, SpotifyArtist *artist) {
+    memset(artist, 0, sizeof(SpotifyArtist));
+    if (skip_null(s) || !expect(s, '{')) return;
+
+    char key[FAST_KEY_SIZE];
+    bool first = true;
+    while (next_key(s, &first, key, sizeof(key))) {
+        if (strcmp(key, "id") == 0) field_string(s, artist->id, sizeof(artist->id));
+        else if (strcmp(key, "name") == 0) field_string(s, artist->name, sizeof(artist->name));
+        else if (strcmp(key, "genres") == 0) field_string_list(s, 5, artist->genres, sizeof(artist->genres));
+        else if (strcmp(key, "uri") == 0) field_string(s, artist->uri, sizeof(artist->uri));
+        else if (strcmp(key, "popularity") == 0) field_int(s, &artist->popularity);
+        else if (strcmp(key, "followers") == 0) field_nested_int(s, "total", &artist->followers);
+        else if (strcmp(key, "images") == 0) field_first_string(s, "url", artist->image_url, sizeof(artist->image_url));
+        else skip_value(s);
+    }
+}
+
+static void scan_playlist(FastScanner *s, SpotifyPlaylist *playlist) {
+    memset(playlist, 0, sizeof(SpotifyPlaylist));
+    if (skip_null(s) || !expect(s, '{')) return;
+
+    char key[FAST_KEY_SIZE];
+    bool first = true;
+    while (next_key(s, &first, key, sizeof(key))) {
+        if (strcmp(key, "id") == 0) field_string(s, playlist->id, sizeof(playlist->id));
+        else if (strcmp(key, "name") == 0) field_string(s, playlist->name, sizeof(playlist->name));
+        else if (strcmp(key, "uri") == 0) field_string(s, playlist->uri, sizeof(playlist->uri));
+        else if (strcmp(key, "public") == 0) field_bool(s, &playlist->is_public);
+        else if (strcmp(key, "tracks") == 0) field_nested_int(s, "total", &playlist->count_tracks);
+        else skip_value(s);
+    }
+}
+
+static void scan_device(FastScanner *s, SpotifyDevice *device) {
+    memset(device, 0, sizeof(SpotifyDevice));
+    if (skip_null(s) || !expect(s, '{')) return;
+
+    char key[FAST_KEY_SIZE];
+    bool first = true;
+    while (next_key(s, &first, key, sizeof(key))) {
+        if (strcmp(key, "id") == 0) field_string(s, device->device_id, sizeof(device->device_id));
+        else if (strcmp(key, "name") == 0) field_string(s, device->device_name, sizeof(device->device_name));
+        else if (strcmp(key, "type") == 0) field_string(s, device->device_type, sizeof(device->device_type));
+        else if (strcmp(key, "volume_percent") == 0) field_int(s, &device->volume_percent);
+        else if (strcmp(key, "is_active") == 0) field_bool(s, &device->is_active);
+        else if (strcmp(key, "is_private_session") == 0) field_bool(s, &device->is_private_session);
+        else if (strcmp(key, "is_restricted") == 0) field_bool(s, &device->is_restricted);
+        else skip_value(s);
+    }
+}
+
+// ===== LISTINGS =====
+
+/**
+ * Position the scanner on the value of a top-level key
+ */
+static bool seek_top_level(FastScanner *s, const char *wanted) {
+    if (!expect(s, '{')) return false;
+
+    char key[FAST_KEY_SIZE];
+    bool first = true;
+    while (next_key(s, &first, key, sizeof(key))) {
+        if (strcmp(key, wanted) == 0) return true;
+        if (!skip_value(s)) return false;
+    }
+    return false;
+}
+
+/**
+ * Grow a struct array geometrically so appending n items costs O(n)
+ */
+static bool reserve(void **items, int *capacity, int needed, size_t item_size) {
+    if (needed <= *capacity) return true;
+
+    int grown_capacity = *capacity * 2 + 16;
+    if (grown_capacity < needed) grown_capacity = needed;
+
+    void *grown = spotify_mem_realloc(*items, item_size * grown_capacity);
+    if (!grown) return false;
+
+    *items = grown;
+    *capacity = grown_capacity;
+    return true;
+}
+
+/**
+ * Append the tracks of the "items" array of a listing page to *tracks
+ *
+ * @param json - Raw response body
+ * @param len - Body size
+ * @param wrapper - Key holding the track in each item ("track"), or NULL when items are tracks
+ * @param tracks - Array to grow (may be NULL)
+ * @param count - Number of tracks already in the array, updated
+ * @return Number of tracks appended, or -1 on malformed input or allocation failure
+ */
+int fast_parse_track_items(const char *json, size_t len, const char *wrapper,
+                           SpotifyTrack **tracks, int *count) {
+    FastScanner s = { json, json + len, false };
+    int capacity = *count;
+    int start = *count;
+
+    if (!seek_top_level(&s, "items")) return -1;
+    if (skip_null(&s)) return 0;
+    if (!expect(&s, '[')) return -1;
+
+    bool first = true;
+    while (next_element(&s, &first)) {
+        if (!reserve((void **)tracks, &capacity, *count + 1, sizeof(SpotifyTrack))) return -1;
+
+        SpotifyTrack *slot = &(*tracks)[*count];
+        if (wrapper) {
+            scan_wrapped_track(&s, wrapper, slot);
+        } else {
+            scan_track(&s, slot);
+        }
+        if (s.error) return -1;
+        (*count)++;
+    }
+
+    return s.error ? -1 : *count - start;
+}
+
+/**
+ * Append the playlists of the "items" array of a listing page, same contract as
+ * fast_parse_track_items()
+ */
+int fast_parse_playlist_items(const char *json, size_t len, SpotifyPlaylist **playlists, int *count) {
+    FastScanner s = { json, json + len, false };
+    int capacity = *count;
+    int start = *count;
+
+    if (!seek_top_level(&s, "items")) return -1;
+    if (skip_null(&s)) return 0;
+    if (!expect(&s, '[')) return -1;
+
+    bool first = true;
+    while (next_element(&s, &first)) {
+        if (!reserve((void **)playlists, &capacity, *count + 1, sizeof(SpotifyPlaylist))) return -1;
+
+        scan_playlist(&s, &(*playlists)[*count]);
+        if (s.error) return -1;
+        (*count)++;
+    }
+
+    return s.error ? -1 : *count - start;
+}
+
+/**
+ * Append the artists of the top-level array_key array ("artists" for
+ * /v1/artists?ids=), same contract as fast_parse_track_items()
+ * null entries (invalid IDs) become zeroed artists
+ */
+int fast_parse_artist_items(const char *json, size_t len, const char *array_key,
+                            SpotifyArtist **artists, int *count) {
+    FastScanner s = { json, json + len, false };
+    int capacity = *count;
+    int start = *count;
+
+    if (!seek_top_level(&s, array_key)) return -1;
+    if (skip_null(&s)) return 0;
+    if (!expect(&s, '[')) return -1;
+
+    bool first = true;
+    while (next_element(&s, &first)) {
+        if (!reserve((void **)artists, &capacity, *count + 1, sizeof(SpotifyArtist))) return -1;
+
+        scan_artist(&s, &(*artists)[*count]);
+        if (s.error) return -1;
+        (*count)++;
+    }
+
+    return s.error ? -1 : *count - start;
+}
+
+/**
+ * Parse a /me/player or /me/player/currently-playing body into state
+ * Returns false on malformed input
+ */
+bool fast_parse_player_state(const char *json, size_t len, SpotifyPlayerState *state) {
+    FastScanner s = { json, json + len, false };
+
+    memset(state, 0, sizeof(SpotifyPlayerState));
+    if (!expect(&s, '{')) return false;
+
+    char key[FAST_KEY_SIZE];
+    bool first = true;
+    while (next_key(&s, &first, key, sizeof(key))) {
+        if (strcmp(key, "item") == 0) {
+            SpotifyTrack track;
+            scan_track(&s, &track);
+            snprintf(state->track_id, sizeof(state->track_id), "%s", track.id);
+            snprintf(state->track_name, sizeof(state->track_name), "%s", track.name);
+            snprintf(state->artist_name, sizeof(state->artist_name), "%s", track.artist);
+            snprintf(state->album_name, sizeof(state->album_name), "%s", track.album);
+            snprintf(state->track_uri, sizeof(state->track_uri), "%s", track.uri);
+            state->duration_ms = track.duration_ms;
+        } else if (strcmp(key, "context") == 0) {
+            if (skip_null(&s) || !expect(&s, '{')) continue;
+
+            char context_key[FAST_KEY_SIZE];
+            bool context_first = true;
+            while (next_key(&s, &context_first, context_key, sizeof(context_key))) {
+                if (strcmp(context_key, "type") == 0) field_string(&s, state->context_type, sizeof(state->context_type));
+                else if (strcmp(context_key, "uri") == 0) field_string(&s, state->context_uri, sizeof(state->context_uri));
+                else skip_value(&s);
+            }
+        }
+        else if (strcmp(key, "is_playing") == 0) field_bool(&s, &state->is_playing);
+        else if (strcmp(key, "progress_ms") == 0) field_int(&s, &state->progress_ms);
+        else if (strcmp(key, "timestamp") == 0) field_int(&s, &state->timestamp);
+        else if (strcmp(key, "shuffle_state") == 0) field_bool(&s, &state->shuffle_state);
+        else if (strcmp(key, "repeat_state") == 0) field_string(&s, state->repeat_state, sizeof(state->repeat_state));
+        else if (strcmp(key, "device") == 0) scan_device(&s, &state->device);
+        else skip_value(&s);
+
+        if (s.error) return false;
+    }
+
+    return !s.error;
+}
@@ -0,0 +1,192 @@
+#include "spotify/spotify_internal.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <curl/curl.h>
+
+/**
+ * Hedged requests for latency-critical reads (player state)
+ *
+ * The first attempt is sent as usual. If it has not answered after the p95
+ * latency of recent hedged requests, an identical second attempt is sent
+ * and whichever succeeds first is used; the other one is abandoned. Only
+ * one extra request is ever sent, so the extra load is about 5%.
+ */
+
+typedef struct {
+    long samples[SPOTIFY_HEDGE_SAMPLES];
+    int count;
+    int next;
+    pthread_mutex_t lock;
+} HedgeLatencies;
+
+static HedgeLatencies latencies = {
+    .lock = PTHREAD_MUTEX_INITIALIZER
+};
+
+typedef struct {
+    CURL *curl;
+    struct curl_slist *headers;
+    SpotifyResponse response;
+    bool finished;
+} HedgeAttempt;
+
+static void record_latency(long latency_ms) {
+    pthread_mutex_lock(&latencies.lock);
+    latencies.samples[latencies.next] = latency_ms;
+    latencies.next = (latencies.next + 1) % SPOTIFY_HEDGE_SAMPLES;
+    if (latencies.count < SPOTIFY_HEDGE_SAMPLES) latencies.count++;
+    pthread_mutex_unlock(&latencies.lock);
+}
+
+static int compare_long(const void *a, const void *b) {
+    long x = *(const long *)a;
+    long y = *(const long *)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * Delay after which a hedged request sends its second attempt
+ */
+long spotify_hedge_delay_ms(void) {
+    long sorted[SPOTIFY_HEDGE_SAMPLES];
+
+    pthread_mutex_lock(&latencies.lock);
+    int count = latencies.count;
+    memcpy(sorted, latencies.samples, sizeof(long) * count);
+    pthread_mutex_unlock(&latencies.lock);
+
+    // A handful of samples says nothing about the tail
+    if (count < 10) return SPOTIFY_HEDGE_DEFAULT_DELAY_MS;
+
+    qsort(sorted, count, sizeof(long), compare_long);
+    long p95 = sorted[(count * 95) / 100];
+
+    return p95 > SPOTIFY_HEDGE_MIN_DELAY_MS ? p95 : SPOTIFY_HEDGE_MIN_DELAY_MS;
+}
+
+static bool attempt_start(CURLM *multi, HedgeAttempt *attempt, SpotifyToken *token,
+                          const SpotifyRequest *request, long long deadline, int index) {
+    SpotifyPool *pool = spotify_token_client(token)->pool;
+    attempt->curl = spotify_pool_acquire(pool);
+    if (!attempt->curl) return false;
+
+    attempt->headers = spotify_request_prepare(attempt->curl, token, request, &attempt->response);
+    curl_easy_setopt(attempt->curl, CURLOPT_PRIVATE, (void *)(intptr_t)index);
+
+    if (!spotify_request_set_deadline(attempt->curl, deadline) ||
+        curl_multi_add_handle(multi, attempt->curl) != CURLM_OK) {
+        curl_slist_free_all(attempt->headers);
+        spotify_pool_release(pool, attempt->curl);
+        attempt->curl = NULL;
+        attempt->headers = NULL;
+        return false;
+    }
+
+    return true;
+}
+
+static void attempt_release(CURLM *multi, HedgeAttempt *attempt) {
+    if (!attempt->curl) return;
+
+    curl_multi_remove_handle(multi, attempt->curl);
+    curl_slist_free_all(attempt->headers);
+    spotify_pool_release(attempt->response.client->pool, attempt->curl);
+    attempt->curl = NULL;
+    attempt->headers = NULL;
+}
+
+bool spotify_request_hedged(SpotifyToken *token, const SpotifyRequest *request,
+                            SpotifyResponse *response) {
+    SpotifyRequestClass cls = spotify_request_class(request);
+    long long deadline = spotify_request_deadline(request);
+
+    if (!spotify_ratelimit_acquire(cls, &deadline, spotify_request_waits_for_limit(request))) {
+        fprintf(stderr, "Deadline exceeded waiting for the rate limit: %s\n", request->url);
+        return false;
+    }
+
+    CURLM *multi = curl_multi_init();
+    if (!multi) return false;
+
+    HedgeAttempt attempts[2];
+    memset(attempts, 0, sizeof(attempts));
+    for (int i = 0; i < 2; i++) {
+        attempts[i].response.client = response->client;
+        attempts[i].response.account = response->account;
+    }
+
+    // A stale cache entry attached by the lookup is revalidated by the first attempt only
+    attempts[0].response.cache_entry = response->cache_entry;
+    response->cache_entry = NULL;
+
+    long long hedge_at = spotify_monotonic_ms() + spotify_hedge_delay_ms();
+    int launched = attempt_start(multi, &attempts[0], token, request, deadline, 0) ? 1 : 0;
+    int finished = 0;
+    int winner = -1;
+
+    while (winner < 0 && finished < launched) {
+        int running;
+        curl_multi_perform(multi, &running);
+
+        CURLMsg *msg;
+        int pending;
+        while ((msg = curl_multi_info_read(multi, &pending))) {
+            if (msg->msg != CURLMSG_DONE) continue;
+
+            void *priv = NULL;
+            curl_easy_getinfo(msg->easy_handle, CURLINFO_PRIVATE, &priv);
+            int index = (int)(intptr_t)priv;
+            HedgeAttempt *attempt = &attempts[index];
+
+            bool ok = spotify_request_finish(attempt->curl, request, &attempt->response, msg->data.result);
+            attempt->finished = true;
+            finished++;
+
+            if (ok) {
+                curl_off_t total_time = 0;
+                curl_easy_getinfo(attempt->curl, CURLINFO_TOTAL_TIME_T, &total_time);
+                record_latency((long)(total_time / 1000));
+                if (winner < 0) winner = index;
+            }
+        }
+        if (winner >= 0) break;
+
+        long long now = spotify_monotonic_ms();
+
+        // Hedge when the first attempt is slow, or retry at once if it failed transiently
+        if (launched == 1) {
+            bool failed = attempts[0].finished;
+            bool retry = failed && spotify_retry_transient(&attempts[0].response);
+
+            if ((!failed && now >= hedge_at) || retry) {
+                if (spotify_ratelimit_reserve(cls) == 0 &&
+                    attempt_start(multi, &attempts[1], token, request, deadline, 1)) {
+                    launched = 2;
+                    continue;
+                }
+                hedge_at = deadline;
+            }
+        }
+
+        long wait = (long)((launched == 1 && hedge_at < deadline ? hedge_at : deadline) - now);
+        if (wait < 1) wait = 1;
+        if (wait > 1000) wait = 1000;
+        if (finished < launched) {
+            curl_multi_poll(multi, NULL, 0, (int)wait, NULL);
+        }
+    }
+
+    // Keep the winner (or the last failure, for its status), abandon the rest
+    int kept = winner >= 0 ? winner : (attempts[1].finished ? 1 : 0);
+    for (int i = 0; i < 2; i++) {
+        attempt_release(multi, &attempts[i]);
+        if (i != kept) spotify_response_free(&attempts[i].response);
+    }
+    curl_multi_cleanup(multi);
+
+    *response = attempts[kept].response;
+    return winner >= 0;
+}
@@ -2,414 +2,634 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <strings.h>
 #include <curl/curl.h>
 
-typedef struct {
-    char *data;
-    size_t size;
-} MemoryStruct;
-
 size_t write_callback(void *contents, size_t size, size_t nmemb, void *userp) {
     size_t realsize = size * nmemb;
-    MemoryStruct *mem = (MemoryStruct *)userp;
+    SpotifyResponse *mem = (SpotifyResponse *)userp;
 
-    char *ptr = realloc(mem->data, mem->size + realsize + 1);
+    char *ptr = realloc(mem->body, mem->body_size + realsize + 1);
     if (!ptr) {
         fprintf(stderr, "Out of memory\n");
         return 0;
     }
 
-    mem->data = ptr;
-    memcpy(&(mem->data[mem->size]), contents, realsize);
-    mem->size += realsize;
-    mem->data[mem->size] = 0;
+    mem->body = ptr;
+    memcpy(&(mem->body[mem->body_size]), contents, realsize);
+    mem->body_size += realsize;
+    mem->body[mem->body_size] = 0;
 
     return realsize;
 }
 
-char* url_encode(const char *str) {
-    CURL *curl = curl_easy_init();
-    if (!curl) return NULL;
-
-    char *encoded = curl_easy_escape(curl, str, 0);
-    char *result = strdup(encoded);
-    curl_free(encoded);
-    curl_easy_cleanup(curl);
-
-    return result;
-}
-
-// ===== HELPER FUNCTIONS =====
-
 /**
- * Performs a GET request to Spotify API
- * Returns parsed JSON object or NULL on error
+ * Feed each chunk straight into an incremental json-c parser
+ * The DOM is built while the body is still downloading and the raw body is never buffered
  */
-struct json_object* spotify_api_get(SpotifyToken *token, const char *url) {
-    CURL *curl = curl_easy_init();
-    if (!curl) return NULL;
+static size_t json_stream_callback(void *contents, size_t size, size_t nmemb, void *userp) {
+    size_t realsize = size * nmemb;
+    SpotifyResponse *response = (SpotifyResponse *)userp;
 
-    MemoryStruct response = {0};
+    response->body_size += realsize;
 
-    char auth_header[1024];
-    snprintf(auth_header, sizeof(auth_header), "Authorization: Bearer %s", token->access_token);
+    // Anything after a complete value is trailing whitespace
+    if (response->json || response->parse_error) return realsize;
 
-    struct curl_slist *headers = NULL;
-    headers = curl_slist_append(headers, auth_header);
+    if (!response->tokener) {
+        response->tokener = json_tokener_new();
+        if (!response->tokener) {
+            fprintf(stderr, "Out of memory\n");
+            return 0;
+        }
+    }
 
-    curl_easy_setopt(curl, CURLOPT_URL, url);
-    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
-    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, write_callback);
-    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &response);
+    response->json = json_tokener_parse_ex(response->tokener, contents, (int)realsize);
+    if (!response->json &&
+        json_tokener_get_error(response->tokener) != json_tokener_continue) {
+        response->parse_error = true;
+    }
 
-    CURLcode res = curl_easy_perform(curl);
+    return realsize;
+}
 
-    curl_slist_free_all(headers);
-    curl_easy_cleanup(curl);
+/**
+ * Flush the incremental parser at end of body
+ * Top-level scalars are only complete once the parser sees the terminator
+ */
+static void json_stream_finish(SpotifyResponse *response) {
+    if (!response->tokener) return;
 
-    if (res != CURLE_OK) {
-        fprintf(stderr, "CURL error: %s\n", curl_easy_strerror(res));
-        free(response.data);
-        return NULL;
+    if (!response->json && !response->parse_error) {
+        response->json = json_tokener_parse_ex(response->tokener, "", 1);
     }
 
-    struct json_object *root = json_tokener_parse(response.data);
-    free(response.data);
+    json_tokener_free(response->tokener);
+    response->tokener = NULL;
+}
 
-    return root;
+// Copy a header value into dst, trimming surrounding whitespace
+static void header_value(const char *value, size_t len, char *dst, size_t size) {
+    while (len > 0 && (*value == ' ' || *value == '\t')) {
+        value++;
+        len--;
+    }
+    while (len > 0 && (value[len - 1] == '\r' || value[len - 1] == '\n' || value[len - 1] == ' ')) {
+        len--;
+    }
+
+    size_t n = len < size - 1 ? len : size - 1;
+    memcpy(dst, value, n);
+    dst[n] = '\0';
 }
 
 /**
- * Performs a PUT request to Spotify API
- * Returns true if response code is 200
+ * Record the response headers the engine acts on (ETag, Cache-Control, Retry-After)
  */
-bool spotify_api_put(SpotifyToken *token, const char *url, const char *json_data) {
-    CURL *curl = curl_easy_init();
-    if (!curl) return false;
+static size_t header_callback(char *buffer, size_t size, size_t nitems, void *userp) {
+    size_t len = size * nitems;
+    SpotifyResponse *response = (SpotifyResponse *)userp;
+
+    // A new status line starts a new header block (redirects, 100-continue)
+    if (len > 5 && strncmp(buffer, "HTTP/", 5) == 0) {
+        response->etag[0] = '\0';
+        response->max_age = 0;
+        response->no_store = false;
+        response->retry_after = 0;
+        return len;
+    }
 
-    char auth_header[1024];
-    snprintf(auth_header, sizeof(auth_header), "Authorization: Bearer %s", token->access_token);
+    if (len > 5 && strncasecmp(buffer, "etag:", 5) == 0) {
+        header_value(buffer + 5, len - 5, response->etag, sizeof(response->etag));
+    } else if (len > 14 && strncasecmp(buffer, "cache-control:", 14) == 0) {
+        char value[256];
+        header_value(buffer + 14, len - 14, value, sizeof(value));
 
-    struct curl_slist *headers = NULL;
-    headers = curl_slist_append(headers, auth_header);
-    headers = curl_slist_append(headers, "Content-Type: application/json");
+        const char *max_age = strstr(value, "max-age=");
+        if (max_age) {
+            response->max_age = strtol(max_age + 8, NULL, 10);
+        }
+        if (strstr(value, "no-store") || strstr(value, "no-cache")) {
+            response->no_store = strstr(value, "no-store") != NULL;
+            if (!response->no_store) response->max_age = 0;
+        }
+        // Meant for one user's client only, never for a cache on disk
+        if (strstr(value, "private")) {
+            response->no_store = true;
+        }
+    } else if (len > 12 && strncasecmp(buffer, "retry-after:", 12) == 0) {
+        // Only the delay-seconds form, Spotify does not send HTTP dates
+        response->retry_after = strtol(buffer + 12, NULL, 10);
+    }
 
-    curl_easy_setopt(curl, CURLOPT_URL, url);
-    curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, "PUT");
-    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
-    curl_easy_setopt(curl, CURLOPT_POSTFIELDS, json_data);
+    return len;
+}
 
-    CURLcode res = curl_easy_perform(curl);
+// Discard bodies nobody asked for, without buffering them
+static size_t discard_callback(void *contents, size_t size, size_t nmemb, void *userp) {
+    (void)contents;
+    SpotifyResponse *response = (SpotifyResponse *)userp;
 
+    response->body_size += size * nmemb;
+    return size * nmemb;
+}
 
-    long response_code;
-    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response_code);
+char* url_encode(const char *str) {
+    SpotifyPool *pool = spotify_default_client()->pool;
+    CURL *curl = spotify_pool_acquire(pool);
+    if (!curl) return NULL;
 
-    curl_slist_free_all(headers);
-    curl_easy_cleanup(curl);
+    char *encoded = curl_easy_escape(curl, str, 0);
+    char *result = strdup(encoded);
+    curl_free(encoded);
+    spotify_pool_release(pool, curl);
 
-    return (res == CURLE_OK && response_code == 200);
+    return result;
 }
 
 /**
- * Performs a PUT request to Spotify API (without body)
- * Returns true if response code is 204 (No Content)
+ * Build "<base>?ids=a,b,c" into url
  */
-bool spotify_api_put_empty(SpotifyToken *token, const char *url) {
-    CURL *curl = curl_easy_init();
-    if (!curl) return false;
-
-    char auth_header[1024];
-    snprintf(auth_header, sizeof(auth_header), "Authorization: Bearer %s", token->access_token);
+void spotify_build_ids_url(char *url, size_t size, const char *base, const char **ids, int count) {
+    snprintf(url, size, "%s?ids=", base);
 
-    struct curl_slist *headers = NULL;
-    headers = curl_slist_append(headers, auth_header);
-    headers = curl_slist_append(headers, "Content-Length: 0");
+    for (int i = 0; i < count; i++) {
+        if (i > 0) strncat(url, ",", size - strlen(url) - 1);
+        strncat(url, ids[i], size - strlen(url) - 1);
+    }
+}
 
-    curl_easy_setopt(curl, CURLOPT_URL, url);
-    curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, "PUT");
-    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
+// ===== REQUEST ENGINE =====
 
-    CURLcode res = curl_easy_perform(curl);
+static const char *method_names[] = {
+    [SPOTIFY_METHOD_GET] = "GET",
+    [SPOTIFY_METHOD_PUT] = "PUT",
+    [SPOTIFY_METHOD_POST] = "POST",
+    [SPOTIFY_METHOD_DELETE] = "DELETE"
+};
 
-    long response_code;
-    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response_code);
+const char* spotify_method_name(SpotifyMethod method) {
+    return method_names[method];
+}
 
-    curl_slist_free_all(headers);
-    curl_easy_cleanup(curl);
+/**
+ * Returns true if status matches the request's expected status list
+ * An empty list accepts any status (GET callers inspect the body themselves)
+ */
+static bool status_expected(const SpotifyRequest *request, long status) {
+    if (request->expected_status[0] == 0) return true;
 
-    // Spotify returns 204 No Content on success
-    return (res == CURLE_OK && response_code == 204);
+    for (int i = 0; i < SPOTIFY_MAX_EXPECTED_STATUS && request->expected_status[i]; i++) {
+        if (request->expected_status[i] == status) return true;
+    }
+    return false;
 }
 
 /**
- * Performs a PUT request to Spotify API and returns JSON response
- * Returns parsed JSON object or NULL on error
+ * Configure an easy handle for a request descriptor
+ * Returns the header list, which must stay alive until the transfer ends
  */
-struct json_object* spotify_api_put_json(SpotifyToken *token, const char *url,
-                                         const char *json_data) {
-    CURL *curl = curl_easy_init();
-    if (!curl) return NULL;
+struct curl_slist* spotify_request_prepare(CURL *curl, SpotifyToken *token,
+                                           const SpotifyRequest *request,
+                                           SpotifyResponse *response) {
+    response->client = spotify_token_client(token);
+    response->account = spotify_cache_account(token);
 
-    MemoryStruct response = {0};
+    char access_token[sizeof(token->access_token)];
+    spotify_token_bearer(token, access_token, sizeof(access_token));
 
     char auth_header[1024];
-    snprintf(auth_header, sizeof(auth_header), "Authorization: Bearer %s", token->access_token);
+    snprintf(auth_header, sizeof(auth_header), "Authorization: Bearer %s", access_token);
+
+    bool has_body = request->body && request->body[0] != '\0';
 
     struct curl_slist *headers = NULL;
     headers = curl_slist_append(headers, auth_header);
-    headers = curl_slist_append(headers, "Content-Type: application/json");
-
-    curl_easy_setopt(curl, CURLOPT_URL, url);
-    curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, "PUT");
-    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
-    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, write_callback);
-    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &response);
-
-    if (json_data && strlen(json_data) > 0) {
-        curl_easy_setopt(curl, CURLOPT_POSTFIELDS, json_data);
+    if (has_body) {
+        headers = curl_slist_append(headers, "Content-Type: application/json");
+    } else if (request->method != SPOTIFY_METHOD_GET) {
+        headers = curl_slist_append(headers, "Content-Length: 0");
     }
 
-    CURLcode res = curl_easy_perform(curl);
+    const char *etag = spotify_cache_etag(response);
+    if (etag) {
+        char condition[SPOTIFY_ETAG_SIZE + 32];
+        snprintf(condition, sizeof(condition), "If-None-Match: %s", etag);
+        headers = curl_slist_append(headers, condition);
+    }
 
-    long response_code;
-    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response_code);
+    curl_easy_setopt(curl, CURLOPT_URL, request->url);
+    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
 
-    curl_slist_free_all(headers);
-    curl_easy_cleanup(curl);
+    // Offer every encoding curl was built with; bodies are decoded chunk by
+    // chunk before they reach the write callbacks below
+    curl_easy_setopt(curl, CURLOPT_ACCEPT_ENCODING, "");
+
+    switch (request->method) {
+        case SPOTIFY_METHOD_GET:
+            curl_easy_setopt(curl, CURLOPT_HTTPGET, 1L);
+            break;
+        case SPOTIFY_METHOD_POST:
+            curl_easy_setopt(curl, CURLOPT_POST, 1L);
+            if (!has_body) {
+                curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, 0L);
+            }
+            break;
+        case SPOTIFY_METHOD_PUT:
+        case SPOTIFY_METHOD_DELETE:
+            curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, spotify_method_name(request->method));
+            break;
+    }
 
-    if (res != CURLE_OK) {
-        fprintf(stderr, "CURL error: %s\n", curl_easy_strerror(res));
-        free(response.data);
-        return NULL;
+    if (has_body) {
+        curl_easy_setopt(curl, CURLOPT_POSTFIELDS, request->body);
     }
 
-    // Check for successful response codes (200, 201)
-    if (response_code != 200 && response_code != 201) {
-        fprintf(stderr, "HTTP error: %ld\n", response_code);
-        if (response.data) {
-            fprintf(stderr, "Response: %s\n", response.data);
-        }
-        free(response.data);
-        return NULL;
+    switch (request->sink) {
+        case SPOTIFY_SINK_NONE:
+            curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, discard_callback);
+            curl_easy_setopt(curl, CURLOPT_WRITEDATA, response);
+            break;
+        case SPOTIFY_SINK_BUFFER:
+            curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, write_callback);
+            curl_easy_setopt(curl, CURLOPT_WRITEDATA, response);
+            break;
+        case SPOTIFY_SINK_JSON:
+            curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, json_stream_callback);
+            curl_easy_setopt(curl, CURLOPT_WRITEDATA, response);
+            break;
     }
 
-    struct json_object *root = json_tokener_parse(response.data);
-    free(response.data);
+    curl_easy_setopt(curl, CURLOPT_HEADERFUNCTION, header_callback);
+    curl_easy_setopt(curl, CURLOPT_HEADERDATA, response);
 
-    return root;
+    return headers;
 }
 
 /**
- * Performs a POST request to Spotify API
- * Returns true if response code is 204 (No Content)
+ * Absolute deadline of a request starting now
  */
-bool spotify_api_post(SpotifyToken *token, const char *url, const char *json_data) {
-    CURL *curl = curl_easy_init();
-    if (!curl) return false;
-
-    char auth_header[1024];
-    snprintf(auth_header, sizeof(auth_header), "Authorization: Bearer %s", token->access_token);
+long long spotify_request_deadline(const SpotifyRequest *request) {
+    long timeout = request->timeout_ms > 0 ? request->timeout_ms : SPOTIFY_DEFAULT_TIMEOUT_MS;
+    return spotify_monotonic_ms() + timeout;
+}
 
-    struct curl_slist *headers = NULL;
-    headers = curl_slist_append(headers, auth_header);
-    headers = curl_slist_append(headers, "Content-Type: application/json");
+bool spotify_request_waits_for_limit(const SpotifyRequest *request) {
+    return request->timeout_ms <= 0;
+}
 
-    curl_easy_setopt(curl, CURLOPT_URL, url);
-    curl_easy_setopt(curl, CURLOPT_POST, 1L);
-    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
+/**
+ * Bound the next transfer on curl by what is left until deadline
+ */
+bool spotify_request_set_deadline(CURL *curl, long long deadline) {
+    long long remaining = deadline - spotify_monotonic_ms();
+    if (remaining <= 0) return false;
 
-    if (json_data && strlen(json_data) > 0) {
-        curl_easy_setopt(curl, CURLOPT_POSTFIELDS, json_data);
-    } else {
-        curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, 0L);
+    curl_easy_setopt(curl, CURLOPT_TIMEOUT_MS, (long)remaining);
+    if (remaining < SPOTIFY_CONNECT_TIMEOUT_MS) {
+        curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT_MS, (long)remaining);
     }
-
-    CURLcode res = curl_easy_perform(curl);
-
-    long response_code;
-    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response_code);
-
-    curl_slist_free_all(headers);
-    curl_easy_cleanup(curl);
-
-    // Spotify returns 204 No Content on success
-    return (res == CURLE_OK && response_code == 204);
+    return true;
 }
 
 /**
- * Performs a POST request to Spotify API (without body)
- * Returns true if response code is 204 (No Content)
+ * Collect status and body of a finished transfer into the response
+ * Returns true if the transfer succeeded with an expected status
  */
-bool spotify_api_post_empty(SpotifyToken *token, const char *url) {
-    CURL *curl = curl_easy_init();
-    if (!curl) return false;
+bool spotify_request_finish(CURL *curl, const SpotifyRequest *request,
+                            SpotifyResponse *response, CURLcode res) {
+    response->curl_code = res;
+    json_stream_finish(response);
+
+    curl_off_t total_time = 0;
+    curl_off_t wire_bytes = 0;
+    curl_easy_getinfo(curl, CURLINFO_TOTAL_TIME_T, &total_time);
+    curl_easy_getinfo(curl, CURLINFO_SIZE_DOWNLOAD_T, &wire_bytes);
+    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response->status);
+    SpotifyLimiter *limiter = response->client->limiter;
+    spotify_limiter_record(limiter, res, response->status, (long)(total_time / 1000));
+    spotify_pool_transfer_done(response->client->pool, curl, res);
+    spotify_limiter_record_bytes(limiter, request->url, wire_bytes, (long long)response->body_size);
 
-    char auth_header[1024];
-    snprintf(auth_header, sizeof(auth_header), "Authorization: Bearer %s", token->access_token);
+    if (res != CURLE_OK) {
+        fprintf(stderr, "CURL error: %s\n", curl_easy_strerror(res));
+        return false;
+    }
 
-    struct curl_slist *headers = NULL;
-    headers = curl_slist_append(headers, auth_header);
-    headers = curl_slist_append(headers, "Content-Length: 0");
+    // Rate limited: pause this class of requests, the caller requeues
+    if (response->status == 429) {
+        spotify_ratelimit_throttled(spotify_request_class(request), response->retry_after);
+        return false;
+    }
 
-    curl_easy_setopt(curl, CURLOPT_URL, url);
-    curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, "POST");
-    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
+    // Token expired or revoked: the caller refreshes it and replays
+    if (response->status == 401) return false;
 
-    CURLcode res = curl_easy_perform(curl);
+    // 304 Not Modified is answered from the cache, 200 refreshes it
+    if (!response->parse_error && !spotify_cache_store(request, response)) {
+        fprintf(stderr, "Cache entry vanished for %s\n", request->url);
+        return false;
+    }
 
-    long response_code;
-    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response_code);
+    if (!status_expected(request, response->status)) {
+        fprintf(stderr, "HTTP error: %ld\n", response->status);
+        if (response->body) {
+            fprintf(stderr, "Response: %s\n", response->body);
+        } else if (response->json) {
+            fprintf(stderr, "Response: %s\n", json_object_to_json_string(response->json));
+        }
+        return false;
+    }
 
-    curl_slist_free_all(headers);
-    curl_easy_cleanup(curl);
+    if (response->parse_error) {
+        fprintf(stderr, "Invalid JSON in response from %s\n", request->url);
+        return false;
+    }
 
-    // Spotify returns 204 No Content on success
-    return (res == CURLE_OK && response_code == 204);
+    return true;
 }
 
 /**
- * Performs a POST request to Spotify API and returns JSON response
- * Returns parsed JSON object or NULL on error
+ * Send a request until it succeeds, its retry policy gives up or its deadline passes
  */
-struct json_object* spotify_api_post_json(SpotifyToken *token, const char *url,
-                                          const char *json_data) {
-    CURL *curl = curl_easy_init();
-    if (!curl) return NULL;
-
-    MemoryStruct response = {0};
-
-    char auth_header[1024];
-    snprintf(auth_header, sizeof(auth_header), "Authorization: Bearer %s", token->access_token);
-
-    struct curl_slist *headers = NULL;
-    headers = curl_slist_append(headers, auth_header);
-    headers = curl_slist_append(headers, "Content-Type: application/json");
+static bool request_attempts(SpotifyToken *token, const SpotifyRequest *request,
+                             SpotifyResponse *response) {
+    SpotifyRequestClass cls = spotify_request_class(request);
+    long long deadline = spotify_request_deadline(request);
+    bool waits = spotify_request_waits_for_limit(request);
+    SpotifyPool *pool = response->client->pool;
+    bool ok = false;
+
+    for (int attempt = 0; ; attempt++) {
+        if (!spotify_ratelimit_acquire(cls, &deadline, waits)) {
+            fprintf(stderr, "Deadline exceeded waiting for the rate limit: %s\n", request->url);
+            break;
+        }
 
-    curl_easy_setopt(curl, CURLOPT_URL, url);
-    curl_easy_setopt(curl, CURLOPT_POST, 1L);
-    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
-    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, write_callback);
-    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &response);
+        CURL *curl = spotify_pool_acquire(pool);
+        if (!curl) return false;
 
-    if (json_data && strlen(json_data) > 0) {
-        curl_easy_setopt(curl, CURLOPT_POSTFIELDS, json_data);
-    } else {
-        curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, 0L);
-    }
+        struct curl_slist *headers = spotify_request_prepare(curl, token, request, response);
+        spotify_request_set_deadline(curl, deadline);
+        CURLcode res = curl_easy_perform(curl);
+        ok = spotify_request_finish(curl, request, response, res);
 
-    CURLcode res = curl_easy_perform(curl);
+        curl_slist_free_all(headers);
+        spotify_pool_release(pool, curl);
 
-    long response_code;
-    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response_code);
+        if (ok) break;
 
-    curl_slist_free_all(headers);
-    curl_easy_cleanup(curl);
+        long delay = spotify_retry_delay(request, response, attempt);
+        if (delay < 0 || spotify_monotonic_ms() + delay >= deadline) break;
 
-    if (res != CURLE_OK) {
-        fprintf(stderr, "CURL error: %s\n", curl_easy_strerror(res));
-        free(response.data);
-        return NULL;
-    }
-
-    // Check for successful response codes (200, 201)
-    if (response_code != 200 && response_code != 201) {
-        fprintf(stderr, "HTTP error: %ld\n", response_code);
-        if (response.data) {
-            fprintf(stderr, "Response: %s\n", response.data);
+        if (delay > 0) {
+            fprintf(stderr, "Retrying %s %s in %ld ms\n", spotify_method_name(request->method),
+                    request->url, delay);
         }
-        free(response.data);
-        return NULL;
+        spotify_response_reset(response);
+        spotify_sleep_ms(delay);
     }
 
-    struct json_object *root = json_tokener_parse(response.data);
-    free(response.data);
+    if (!ok && response->status == 429) {
+        fprintf(stderr, "HTTP error: 429 (still rate limited after %d retries)\n",
+                SPOTIFY_RETRY_MAX_ATTEMPTS);
+    }
 
-    return root;
+    return ok;
 }
 
 /**
- * Performs a DELETE request to Spotify API with JSON body
- * Returns parsed JSON object or NULL on error
+ * Performs a request described by a SpotifyRequest
+ * Fills response and returns true on success; release it with spotify_response_free()
+ * Fresh cached GET responses are returned without a transfer, and a GET
+ * identical to one already in flight waits for that one's result.
+ * Requests are paced by the rate limiter; 429s and transient failures are
+ * resent as the request's retry policy allows, until the request's deadline.
+ * A 401 refreshes the access token and replays the request once.
  */
-struct json_object* spotify_api_delete_json(SpotifyToken *token, const char *url,
-                                            const char *json_data) {
-    CURL *curl = curl_easy_init();
-    if (!curl) return NULL;
-
-    MemoryStruct response = {0};
-
-    char auth_header[1024];
-    snprintf(auth_header, sizeof(auth_header), "Authorization: Bearer %s", token->access_token);
-
-    struct curl_slist *headers = NULL;
-    headers = curl_slist_append(headers, auth_header);
-    headers = curl_slist_append(headers, "Content-Type: application/json");
+bool spotify_request_perform(SpotifyToken *token, const SpotifyRequest *request,
+                             SpotifyResponse *response) {
+    memset(response, 0, sizeof(SpotifyResponse));
+    response->client = spotify_token_client(token);
+    response->account = spotify_cache_account(token);
+    if (spotify_cache_lookup(request, response)) return true;
+
+    SpotifyFlight *flight = NULL;
+    bool ok = false;
+    if (spotify_singleflight_join(token, request, response, &ok, &flight)) {
+        // Answered by the request in flight, the attached stale entry is not needed
+        spotify_cache_entry_free(response->cache_entry);
+        response->cache_entry = NULL;
+        return ok;
+    }
 
-    curl_easy_setopt(curl, CURLOPT_URL, url);
-    curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, "DELETE");
-    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
-    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, write_callback);
-    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &response);
+    // A 401 means the request was not processed: refresh the token once and replay it
+    for (int replay = 0; replay < 2; replay++) {
+        unsigned generation = spotify_token_generation(token);
+        if (request->hedge) {
+            ok = spotify_request_hedged(token, request, response);
+        } else {
+            ok = request_attempts(token, request, response);
+        }
 
-    if (json_data && strlen(json_data) > 0) {
-        curl_easy_setopt(curl, CURLOPT_POSTFIELDS, json_data);
+        if (ok || response->status != 401) break;
+        if (replay > 0 || !spotify_token_refresh(token, generation)) {
+            fprintf(stderr, "HTTP error: 401 (access token rejected)\n");
+            break;
+        }
+        spotify_response_reset(response);
     }
 
-    CURLcode res = curl_easy_perform(curl);
+    spotify_singleflight_end(flight, response, ok);
+    return ok;
+}
 
-    long response_code;
-    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response_code);
+void spotify_response_free(SpotifyResponse *response) {
+    if (!response) return;
+    free(response->body);
+    response->body = NULL;
+    response->body_size = 0;
+    if (response->tokener) {
+        json_tokener_free(response->tokener);
+        response->tokener = NULL;
+    }
+    if (response->json) {
+        json_object_put(response->json);
+        response->json = NULL;
+    }
+    spotify_cache_entry_free(response->cache_entry);
+    response->cache_entry = NULL;
+}
 
-    curl_slist_free_all(headers);
-    curl_easy_cleanup(curl);
+/**
+ * Clear a finished response so its request can be sent again
+ * The attached cache entry is kept for revalidation
+ */
+void spotify_response_reset(SpotifyResponse *response) {
+    SpotifyCacheEntry *entry = response->cache_entry;
+    SpotifyClient *client = response->client;
+    unsigned long long account = response->account;
+    response->cache_entry = NULL;
+
+    spotify_response_free(response);
+    memset(response, 0, sizeof(SpotifyResponse));
+    response->cache_entry = entry;
+    response->client = client;
+    response->account = account;
+}
 
-    if (res != CURLE_OK) {
-        fprintf(stderr, "CURL error: %s\n", curl_easy_strerror(res));
-        free(response.data);
-        return NULL;
-    }
+/**
+ * Run a request and hand the parsed JSON over to the caller
+ */
+static struct json_object* request_json(SpotifyToken *token, const SpotifyRequest *request) {
+    SpotifyResponse response;
+    struct json_object *root = NULL;
 
-    // Check for successful response code (200)
-    if (response_code != 200) {
-        fprintf(stderr, "HTTP error: %ld\n", response_code);
-        if (response.data) {
-            fprintf(stderr, "Response: %s\n", response.data);
-        }
-        free(response.data);
-        return NULL;
+    if (spotify_request_perform(token, request, &response)) {
+        root = response.json;
+        response.json = NULL;
     }
 
-    struct json_object *root = json_tokener_parse(response.data);
-    free(response.data);
-
+    spotify_response_free(&response);
     return root;
 }
 
-bool spotify_api_delete_empty(SpotifyToken *token, const char *url) {
-    CURL *curl = curl_easy_init();
-    if (!curl) return false;
+/**
+ * Run a request whose body is not needed
+ */
+static bool request_status(SpotifyToken *token, const SpotifyRequest *request) {
+    SpotifyResponse response;
+    bool ok = spotify_request_perform(token, request, &response);
+    spotify_response_free(&response);
+    return ok;
+}
 
-    char auth_header[1024];
-    snprintf(auth_header, sizeof(auth_header), "Authorization: Bearer %s", token->access_token);
+// ===== HELPER FUNCTIONS =====
 
-    struct curl_slist *headers = NULL;
-    headers = curl_slist_append(headers, auth_header);
-    headers = curl_slist_append(headers, "Content-Length: 0");
+/**
+ * Performs a GET request to Spotify API
+ * Returns parsed JSON object or NULL on error
+ */
+struct json_object* spotify_api_get(SpotifyToken *token, const char *url) {
+    SpotifyRequest request = {
+        .method = SPOTIFY_METHOD_GET,
+        .url = url,
+        .sink = SPOTIFY_SINK_JSON
+    };
+    return request_json(token, &request);
+}
 
-    curl_easy_setopt(curl, CURLOPT_URL, url);
-    curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, "DELETE");
-    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
+/**
+ * Performs a PUT request to Spotify API
+ * Returns true if response code is 200
+ */
+bool spotify_api_put(SpotifyToken *token, const char *url, const char *json_data) {
+    SpotifyRequest request = {
+        .method = SPOTIFY_METHOD_PUT,
+        .url = url,
+        .body = json_data,
+        .expected_status = {200}
+    };
+    return request_status(token, &request);
+}
 
-    CURLcode res = curl_easy_perform(curl);
+/**
+ * Performs a PUT request to Spotify API (without body)
+ * Returns true if response code is 204 (No Content)
+ */
+bool spotify_api_put_empty(SpotifyToken *token, const char *url) {
+    SpotifyRequest request = {
+        .method = SPOTIFY_METHOD_PUT,
+        .url = url,
+        .expected_status = {204}
+    };
+    return request_status(token, &request);
+}
+
+/**
+ * Performs a PUT request to Spotify API and returns JSON response
+ * Returns parsed JSON object or NULL on error
+ */
+struct json_object* spotify_api_put_json(SpotifyToken *token, const char *url,
+                                         const char *json_data) {
+    SpotifyRequest request = {
+        .method = SPOTIFY_METHOD_PUT,
+        .url = url,
+        .body = json_data,
+        .expected_status = {200, 201},
+        .sink = SPOTIFY_SINK_JSON
+    };
+    return request_json(token, &request);
+}
+
+/**
+ * Performs a POST request to Spotify API
+ * Returns true if response code is 204 (No Content)
+ */
+bool spotify_api_post(SpotifyToken *token, const char *url, const char *json_data) {
+    SpotifyRequest request = {
+        .method = SPOTIFY_METHOD_POST,
+        .url = url,
+        .body = json_data,
+        .expected_status = {204}
+    };
+    return request_status(token, &request);
+}
 
-    long response_code;
-    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response_code);
+/**
+ * Performs a POST request to Spotify API (without body)
+ * Returns true if response code is 204 (No Content)
+ */
+bool spotify_api_post_empty(SpotifyToken *token, const char *url) {
+    SpotifyRequest request = {
+        .method = SPOTIFY_METHOD_POST,
+        .url = url,
+        .expected_status = {204}
+    };
+    return request_status(token, &request);
+}
 
-    curl_slist_free_all(headers);
-    curl_easy_cleanup(curl);
+/**
+ * Performs a POST request to Spotify API and returns JSON response
+ * Returns parsed JSON object or NULL on error
+ */
+struct json_object* spotify_api_post_json(SpotifyToken *token, const char *url,
+                                          const char *json_data) {
+    SpotifyRequest request = {
+        .method = SPOTIFY_METHOD_POST,
+        .url = url,
+        .body = json_data,
+        .expected_status = {200, 201},
+        .sink = SPOTIFY_SINK_JSON
+    };
+    return request_json(token, &request);
+}
 
-    // Spotify returns 200 No Content on success
-    return (res == CURLE_OK && response_code == 200);
+/**
+ * Performs a DELETE request to Spotify API with JSON body
+ * Returns parsed JSON object or NULL on error
+ */
+struct json_object* spotify_api_delete_json(SpotifyToken *token, const char *url,
+                                            const char *json_data) {
+    SpotifyRequest request = {
+        .method = SPOTIFY_METHOD_DELETE,
+        .url = url,
+        .body = json_data,
+        .expected_status = {200},
+        .sink = SPOTIFY_SINK_JSON
+    };
+    return request_json(token, &request);
 }
 
+/**
+ * Performs a DELETE request to Spotify API (without body)
+ * Returns true if response code is 200
+ */
+bool spotify_api_delete_empty(SpotifyToken *token, const char *url) {
+    SpotifyRequest request = {
+        .method = SPOTIFY_METHOD_DELETE,
+        .url = url,
+        .expected_status = {200}
+    };
+    return request_status(token, &request);
+}
@@ -0,0 +1,283 @@
+#include "spotify/spotify_internal.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <pthread.h>
+
+// Transfer sizes per endpoint ("/playlists/{id}/tracks"), compressed vs decoded
+typedef struct {
+    char endpoint[64];
+    long requests;
+    long long wire_bytes;
+    long long decoded_bytes;
+} EndpointBytes;
+
+/**
+ * Adaptive concurrency limit for batched requests (AIMD)
+ *
+ * Every finished transfer is fed back: while responses succeed and latency
+ * stays near the baseline the window grows by one per window of requests,
+ * and a 429, a 5xx, a transport error or a latency spike halves it. Cuts
+ * are spaced by one baseline round trip so a burst of failures from the
+ * same window only counts once.
+ */
+struct SpotifyLimiter {
+    double window;
+    int max_window;
+    double baseline_ms;     // Smoothed lowest latency, the reference for "flat"
+    long long last_cut;
+
+    // Counters for spotify_get_request_stats()
+    long requests;
+    long cache_hits;
+    long throttled;
+    long errors;
+    long long latency_total_ms;
+    EndpointBytes endpoints[SPOTIFY_STATS_MAX_ENDPOINTS];
+    int endpoint_count;
+
+    pthread_mutex_t lock;
+};
+
+/**
+ * Create a limiter whose window never exceeds max_window (0 for SPOTIFY_BATCH_MAX_PARALLEL)
+ */
+SpotifyLimiter* spotify_limiter_new(int max_window) {
+    SpotifyLimiter *limiter = calloc(1, sizeof(SpotifyLimiter));
+    if (!limiter) return NULL;
+
+    if (max_window <= 0 || max_window > SPOTIFY_BATCH_MAX_PARALLEL) {
+        max_window = SPOTIFY_BATCH_MAX_PARALLEL;
+    }
+    limiter->max_window = max_window;
+    limiter->window = SPOTIFY_LIMITER_INITIAL_WINDOW < max_window ? SPOTIFY_LIMITER_INITIAL_WINDOW : max_window;
+    pthread_mutex_init(&limiter->lock, NULL);
+
+    return limiter;
+}
+
+void spotify_limiter_free(SpotifyLimiter *limiter) {
+    if (!limiter) return;
+    pthread_mutex_destroy(&limiter->lock);
+    free(limiter);
+}
+
+/**
+ * Number of requests a batch may keep in flight right now
+ */
+int spotify_limiter_window(SpotifyLimiter *limiter) {
+    pthread_mutex_lock(&limiter->lock);
+    int window = (int)limiter->window;
+    pthread_mutex_unlock(&limiter->lock);
+
+    return window > 0 ? window : 1;
+}
+
+/**
+ * Feed a finished transfer back into the limiter
+ *
+ * @param res - Transfer result
+ * @param status - HTTP status (ignored when res is not CURLE_OK)
+ * @param latency_ms - Total transfer time
+ */
+void spotify_limiter_record(SpotifyLimiter *limiter, CURLcode res, long status, long latency_ms) {
+    long long now = spotify_monotonic_ms();
+
+    pthread_mutex_lock(&limiter->lock);
+
+    limiter->requests++;
+    limiter->latency_total_ms += latency_ms;
+
+    bool overloaded = res != CURLE_OK || status == 429 || status >= 500;
+    if (status == 429) {
+        limiter->throttled++;
+    } else if (overloaded) {
+        limiter->errors++;
+    }
+
+    bool spike = !overloaded && limiter->baseline_ms > 0 &&
+                 latency_ms > limiter->baseline_ms * SPOTIFY_LIMITER_SPIKE_FACTOR &&
+                 latency_ms > limiter->baseline_ms + SPOTIFY_LIMITER_SPIKE_MIN_MS;
+
+    if (overloaded || spike) {
+        if (now - limiter->last_cut >= (long long)limiter->baseline_ms) {
+            limiter->window *= 0.5;
+            if (limiter->window < 1.0) limiter->window = 1.0;
+            limiter->last_cut = now;
+        }
+    } else {
+        limiter->window += 1.0 / limiter->window;
+        if (limiter->window > limiter->max_window) limiter->window = limiter->max_window;
+    }
+
+    // Follow the fastest responses closely, drift up slowly if the route gets slower
+    if (res == CURLE_OK && !overloaded) {
+        if (limiter->baseline_ms == 0 || latency_ms < limiter->baseline_ms) {
+            limiter->baseline_ms = latency_ms;
+        } else {
+            limiter->baseline_ms += (latency_ms - limiter->baseline_ms) * 0.05;
+        }
+    }
+
+    pthread_mutex_unlock(&limiter->lock);
+}
+
+void spotify_limiter_cache_hit(SpotifyLimiter *limiter) {
+    pthread_mutex_lock(&limiter->lock);
+    limiter->cache_hits++;
+    pthread_mutex_unlock(&limiter->lock);
+}
+
+// Top-level resources whose next path segment is an ID (/albums/{id}, /users/{id}/playlists)
+static const char *ID_COLLECTIONS[] = {
+    "albums", "artists", "audio-analysis", "audio-features", "audiobooks", "chapters",
+    "episodes", "playlists", "shows", "tracks", "users", NULL
+};
+
+static bool segment_is(const char *segment, size_t len, const char *word) {
+    return strlen(word) == len && strncmp(segment, word, len) == 0;
+}
+
+/**
+ * Spotify IDs are 22 base62 characters; user IDs and category IDs vary in
+ * form, so those are recognised by the resource they follow instead
+ */
+static bool segment_is_id(const char *segment, size_t len, const char *previous, size_t previous_len,
+                          int index) {
+    bool base62 = len == 22;
+    for (size_t i = 0; base62 && i < len; i++) {
+        base62 = isalnum((unsigned char)segment[i]);
+    }
+    if (base62) return true;
+    if (!previous) return false;
+
+    if (segment_is(previous, previous_len, "categories")) return true;
+    if (index != 1) return false;
+
+    for (const char **collection = ID_COLLECTIONS; *collection; collection++) {
+        if (segment_is(previous, previous_len, *collection)) return true;
+    }
+    return false;
+}
+
+/**
+ * Reduce a URL to its endpoint: path without host, /v1 and query, IDs replaced by {id}
+ * e.g. .../v1/playlists/37i9.../tracks?offset=50 -> /playlists/{id}/tracks
+ */
+static void endpoint_name(const char *url, char *name, size_t size) {
+    const char *path = strstr(url, "://");
+    path = path ? strchr(path + 3, '/') : url;
+    if (!path) path = "";
+    if (strncmp(path, "/v1/", 4) == 0) path += 3;
+
+    size_t len = 0;
+    name[0] = '\0';
+
+    const char *previous = NULL;
+    size_t previous_len = 0;
+    int index = 0;
+
+    while (*path == '/' && len + 1 < size) {
+        const char *segment = ++path;
+        size_t seg_len = strcspn(segment, "/?#");
+
+        bool id = segment_is_id(segment, seg_len, previous, previous_len, index);
+        const char *text = id ? "{id}" : segment;
+        size_t text_len = id ? 4 : seg_len;
+
+        int n = snprintf(name + len, size - len, "/%.*s", (int)text_len, text);
+        if (n < 0) break;
+        len += (size_t)n < size - len ? (size_t)n : size - len - 1;
+
+        previous = segment;
+        previous_len = seg_len;
+        index++;
+        path = segment + seg_len;
+    }
+}
+
+/**
+ * Account the bytes of a finished transfer to its endpoint
+ *
+ * @param wire_bytes - Body bytes as received (compressed if the server compressed)
+ * @param decoded_bytes - Body bytes after content decoding
+ */
+void spotify_limiter_record_bytes(SpotifyLimiter *limiter, const char *url, long long wire_bytes, long long decoded_bytes) {
+    char name[64];
+    endpoint_name(url, name, sizeof(name));
+
+    pthread_mutex_lock(&limiter->lock);
+
+    EndpointBytes *entry = NULL;
+    for (int i = 0; i < limiter->endpoint_count; i++) {
+        if (strcmp(limiter->endpoints[i].endpoint, name) == 0) {
+            entry = &limiter->endpoints[i];
+            break;
+        }
+    }
+
+    // Table full: fold the rest into the last slot
+    if (!entry && limiter->endpoint_count < SPOTIFY_STATS_MAX_ENDPOINTS) {
+        entry = &limiter->endpoints[limiter->endpoint_count++];
+        snprintf(entry->endpoint, sizeof(entry->endpoint), "%s",
+                 limiter->endpoint_count == SPOTIFY_STATS_MAX_ENDPOINTS ? "(other)" : name);
+    } else if (!entry) {
+        entry = &limiter->endpoints[SPOTIFY_STATS_MAX_ENDPOINTS - 1];
+    }
+
+    entry->requests++;
+    entry->wire_bytes += wire_bytes;
+    entry->decoded_bytes += decoded_bytes;
+
+    pthread_mutex_unlock(&limiter->lock);
+}
+
+// ===== STATS =====
+
+void spotify_limiter_stats(SpotifyLimiter *limiter, SpotifyRequestStats *stats) {
+    pthread_mutex_lock(&limiter->lock);
+    stats->requests = limiter->requests;
+    stats->cache_hits = limiter->cache_hits;
+    stats->throttled = limiter->throttled;
+    stats->errors = limiter->errors;
+    stats->avg_latency_ms = limiter->requests ? (long)(limiter->latency_total_ms / limiter->requests) : 0;
+    stats->baseline_latency_ms = (long)limiter->baseline_ms;
+    stats->concurrency_window = limiter->window;
+    stats->max_concurrency = limiter->max_window;
+
+    stats->wire_bytes = 0;
+    stats->decoded_bytes = 0;
+    for (int i = 0; i < limiter->endpoint_count; i++) {
+        stats->wire_bytes += limiter->endpoints[i].wire_bytes;
+        stats->decoded_bytes += limiter->endpoints[i].decoded_bytes;
+    }
+    pthread_mutex_unlock(&limiter->lock);
+}
+
+void spotify_limiter_print(SpotifyLimiter *limiter) {
+    SpotifyRequestStats stats;
+    spotify_limiter_stats(limiter, &stats);
+
+    fprintf(stderr, "\n=== Request stats ===\n");
+    fprintf(stderr, "Requests:           %ld (+%ld from cache)\n", stats.requests, stats.cache_hits);
+    fprintf(stderr, "Rate limited (429): %ld\n", stats.throttled);
+    fprintf(stderr, "Errors:             %ld\n", stats.errors);
+    fprintf(stderr, "Latency:            %ld ms avg, %ld ms baseline\n",
+            stats.avg_latency_ms, stats.baseline_latency_ms);
+    fprintf(stderr, "Concurrency window: %.1f (max %d)\n",
+            stats.concurrency_window, stats.max_concurrency);
+    fprintf(stderr, "Bytes received:     %lld on the wire, %lld decoded\n",
+            stats.wire_bytes, stats.decoded_bytes);
+
+    pthread_mutex_lock(&limiter->lock);
+    if (limiter->endpoint_count > 0) {
+        fprintf(stderr, "\n%-40s %8s %12s %12s\n", "Endpoint", "Requests", "Wire", "Decoded");
+    }
+    for (int i = 0; i < limiter->endpoint_count; i++) {
+        const EndpointBytes *entry = &limiter->endpoints[i];
+        fprintf(stderr, "%-40s %8ld %12lld %12lld\n", entry->endpoint, entry->requests,
+                entry->wire_bytes, entry->decoded_bytes);
+    }
+    pthread_mutex_unlock(&limiter->lock);
+}
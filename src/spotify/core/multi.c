@@ -0,0 +1,247 @@
+#include "spotify/spotify_internal.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <curl/curl.h>
+
+typedef struct {
+    CURL *curl;
+    struct curl_slist *headers;
+} BatchSlot;
+
+// Add request index to the multi handle, returns false if no handle could be set up
+static bool batch_start(CURLM *multi, BatchSlot *slot, SpotifyToken *token,
+                        const SpotifyRequest *request, SpotifyResponse *response, int index,
+                        long long deadline) {
+    SpotifyPool *pool = spotify_token_client(token)->pool;
+    slot->curl = spotify_pool_acquire(pool);
+    if (!slot->curl) return false;
+
+    slot->headers = spotify_request_prepare(slot->curl, token, request, response);
+    if (!spotify_request_set_deadline(slot->curl, deadline)) {
+        curl_slist_free_all(slot->headers);
+        spotify_pool_release(pool, slot->curl);
+        slot->curl = NULL;
+        slot->headers = NULL;
+        return false;
+    }
+
+    // Wait for an HTTP/2 connection to multiplex on rather than opening a new one
+    curl_easy_setopt(slot->curl, CURLOPT_PIPEWAIT, 1L);
+    curl_easy_setopt(slot->curl, CURLOPT_PRIVATE, (void *)(intptr_t)index);
+
+    if (curl_multi_add_handle(multi, slot->curl) != CURLM_OK) {
+        curl_slist_free_all(slot->headers);
+        spotify_pool_release(pool, slot->curl);
+        slot->curl = NULL;
+        slot->headers = NULL;
+        return false;
+    }
+
+    return true;
+}
+
+static void batch_release(CURLM *multi, BatchSlot *slot, SpotifyPool *pool) {
+    curl_multi_remove_handle(multi, slot->curl);
+    curl_slist_free_all(slot->headers);
+    spotify_pool_release(pool, slot->curl);
+    slot->curl = NULL;
+    slot->headers = NULL;
+}
+
+/**
+ * Perform several requests concurrently over multiplexed connections
+ *
+ * @param token - Valid Spotify token
+ * @param requests - Array of request descriptors
+ * @param count - Number of requests
+ * @param responses - Output array of count responses (free each with spotify_response_free)
+ * @param ok - Optional output array of count success flags
+ * @param on_done - Optional callback invoked as each request completes
+ * @param userdata - Passed through to on_done
+ * @return Number of requests that succeeded
+ */
+int spotify_request_batch(SpotifyToken *token, const SpotifyRequest *requests, int count,
+                          SpotifyResponse *responses, bool *ok,
+                          SpotifyBatchCallback on_done, void *userdata) {
+    if (!token || !requests || !responses || count <= 0) return 0;
+
+    SpotifyClient *client = spotify_token_client(token);
+    unsigned long long account = spotify_cache_account(token);
+
+    memset(responses, 0, sizeof(SpotifyResponse) * count);
+    for (int i = 0; i < count; i++) {
+        responses[i].client = client;
+        responses[i].account = account;
+    }
+    if (ok) memset(ok, 0, sizeof(bool) * count);
+
+    CURLM *multi = curl_multi_init();
+    if (!multi) return 0;
+
+    curl_multi_setopt(multi, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
+
+    BatchSlot *slots = calloc(count, sizeof(BatchSlot));
+    int *queue = malloc(sizeof(int) * count);
+    int *attempts = calloc(count, sizeof(int));
+    long long *not_before = calloc(count, sizeof(long long));
+    long long *deadlines = malloc(sizeof(long long) * count);
+    bool *replayed = calloc(count, sizeof(bool));
+    if (!slots || !queue || !attempts || !not_before || !deadlines || !replayed) {
+        free(slots);
+        free(queue);
+        free(attempts);
+        free(not_before);
+        free(deadlines);
+        free(replayed);
+        curl_multi_cleanup(multi);
+        return 0;
+    }
+
+    int in_flight = 0;
+    int done = 0;
+    long long limited_since = 0;    // Queue head held by the rate limiter since
+    int succeeded = 0;
+    unsigned generation = spotify_token_generation(token);
+
+    // Fresh cache hits complete without a transfer, the rest wait in a FIFO
+    int head = 0;
+    int queued = 0;
+    for (int index = 0; index < count; index++) {
+        deadlines[index] = spotify_request_deadline(&requests[index]);
+        if (spotify_cache_lookup(&requests[index], &responses[index])) {
+            done++;
+            succeeded++;
+            if (ok) ok[index] = true;
+            if (on_done) on_done(index, true, &responses[index], userdata);
+        } else {
+            queue[queued++] = index;
+        }
+    }
+
+    while (done < count) {
+        long wait_ms = 1000;
+        int window = spotify_limiter_window(client->limiter);
+
+        // Keep the adaptive concurrency window full, as far as the rate limiter allows
+        while (queued > 0 && in_flight < window) {
+            int index = queue[head];
+
+            // Backing off after a transient failure
+            long long now = spotify_monotonic_ms();
+            long delay = (long)(not_before[index] - now);
+            bool limited = false;
+            if (delay <= 0) {
+                delay = spotify_ratelimit_reserve(spotify_request_class(&requests[index]));
+                limited = delay > 0;
+            }
+
+            // Time the queue was held by the rate limiter does not count against default deadlines
+            if (limited && !limited_since) limited_since = now;
+            if (!limited && limited_since) {
+                for (int i = 0; i < queued; i++) {
+                    int held = queue[(head + i) % count];
+                    if (spotify_request_waits_for_limit(&requests[held])) {
+                        deadlines[held] += now - limited_since;
+                    }
+                }
+                limited_since = 0;
+            }
+
+            bool expired = limited && spotify_request_waits_for_limit(&requests[index])
+                               ? delay > SPOTIFY_RATELIMIT_MAX_WAIT_MS
+                               : now + delay >= deadlines[index];
+            if (delay > 0 && !expired) {
+                if (delay < wait_ms) wait_ms = delay;
+                break;
+            }
+
+            head = (head + 1) % count;
+            queued--;
+
+            if (!expired && batch_start(multi, &slots[index], token, &requests[index], &responses[index],
+                                        index, deadlines[index])) {
+                in_flight++;
+            } else {
+                fprintf(stderr, expired ? "Deadline exceeded: %s\n" : "Failed to start request: %s\n",
+                        requests[index].url);
+                done++;
+                if (on_done) on_done(index, false, &responses[index], userdata);
+            }
+        }
+
+        if (in_flight == 0) {
+            // Everything left is waiting for the rate limiter
+            if (queued > 0) spotify_sleep_ms(wait_ms);
+            continue;
+        }
+
+        int running;
+        curl_multi_perform(multi, &running);
+
+        CURLMsg *msg;
+        int pending;
+        while ((msg = curl_multi_info_read(multi, &pending))) {
+            if (msg->msg != CURLMSG_DONE) continue;
+
+            CURL *easy = msg->easy_handle;
+            CURLcode res = msg->data.result;
+
+            void *priv = NULL;
+            curl_easy_getinfo(easy, CURLINFO_PRIVATE, &priv);
+            int index = (int)(intptr_t)priv;
+
+            bool result = spotify_request_finish(easy, &requests[index], &responses[index], res);
+            batch_release(multi, &slots[index], client->pool);
+            in_flight--;
+
+            // Back to the end of the queue; after a 429 the rate limiter holds it until Retry-After
+            if (!result) {
+                long retry = spotify_retry_delay(&requests[index], &responses[index], attempts[index]++);
+
+                // Rejected token: replay once with a refreshed one (one refresh for the whole batch)
+                if (responses[index].status == 401) {
+                    retry = -1;
+                    if (!replayed[index] && spotify_token_refresh(token, generation)) {
+                        replayed[index] = true;
+                        retry = 0;
+                    } else {
+                        fprintf(stderr, "HTTP error: 401 (access token rejected)\n");
+                    }
+                }
+
+                if (retry >= 0 && spotify_monotonic_ms() + retry < deadlines[index]) {
+                    spotify_response_reset(&responses[index]);
+                    not_before[index] = spotify_monotonic_ms() + retry;
+                    queue[(head + queued) % count] = index;
+                    queued++;
+                    continue;
+                }
+                if (responses[index].status == 429) {
+                    fprintf(stderr, "HTTP error: 429 (still rate limited after %d retries)\n",
+                            SPOTIFY_RETRY_MAX_ATTEMPTS);
+                }
+            }
+
+            done++;
+            if (result) succeeded++;
+            if (ok) ok[index] = result;
+            if (on_done) on_done(index, result, &responses[index], userdata);
+        }
+
+        if (in_flight > 0) {
+            curl_multi_poll(multi, NULL, 0, (int)wait_ms, NULL);
+        }
+    }
+
+    free(slots);
+    free(queue);
+    free(attempts);
+    free(not_before);
+    free(deadlines);
+    free(replayed);
+    curl_multi_cleanup(multi);
+
+    return succeeded;
+}
@@ -0,0 +1,405 @@
+#include "spotify/spotify_internal.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <curl/curl.h>
+
+#define NETCACHE_MAGIC "SPOTCLI-NET 1"
+
+// TLS session import/export appeared in libcurl 8.12
+#if LIBCURL_VERSION_NUM >= 0x080c00
+#define NETCACHE_TLS_SESSIONS 1
+#endif
+
+/**
+ * Connection state that outlives the process
+ *
+ * One-shot invocations would otherwise resolve api.spotify.com and
+ * accounts.spotify.com and do a full TLS handshake every time. The
+ * addresses connected to are stored with the time they were learned and
+ * fed back through CURLOPT_RESOLVE ("+" entries, which expire like normal
+ * DNS cache entries) while younger than SPOTIFY_NETCACHE_DNS_TTL_S. With
+ * libcurl 8.12 or newer the share's TLS sessions are exported as well, so
+ * the next process resumes them instead of doing a full handshake.
+ *
+ * Everything lives in one text file under ~/.config/spotCLI/net, replaced
+ * atomically when the pool is freed.
+ */
+
+typedef struct {
+    char host[256];
+    long port;
+    char ip[64];
+    time_t learned_at;
+} NetHost;
+
+#ifdef NETCACHE_TLS_SESSIONS
+typedef struct {
+    char *key;
+    unsigned char *shmac;
+    size_t shmac_len;
+    unsigned char *sdata;
+    size_t sdata_len;
+} NetSession;
+#endif
+
+struct SpotifyNetCache {
+    char path[640];
+    NetHost hosts[SPOTIFY_NETCACHE_MAX_HOSTS];
+    int host_count;
+    struct curl_slist *resolve;     // Kept alive until the handle using it has run
+    struct curl_slist *purge;       // Removes the injected entries again
+    bool applied;                   // A transfer ran with the stored addresses
+    bool purge_pending;
+    bool used;                      // A transfer ran, so sessions may have changed
+    bool dirty;                     // Addresses changed
+#ifdef NETCACHE_TLS_SESSIONS
+    NetSession *sessions;
+    int session_count;
+#endif
+    pthread_mutex_t lock;
+};
+
+// ===== ENCODING =====
+
+#ifdef NETCACHE_TLS_SESSIONS
+static void hex_encode(FILE *f, const unsigned char *data, size_t len) {
+    if (len == 0) fputc('-', f);
+    for (size_t i = 0; i < len; i++) {
+        fprintf(f, "%02x", data[i]);
+    }
+}
+
+static unsigned char* hex_decode(const char *hex, size_t *len) {
+    *len = 0;
+    if (strcmp(hex, "-") == 0) return calloc(1, 1);
+
+    size_t hex_len = strlen(hex);
+    if (hex_len % 2 != 0) return NULL;
+
+    unsigned char *data = malloc(hex_len / 2 + 1);
+    if (!data) return NULL;
+
+    for (size_t i = 0; i < hex_len / 2; i++) {
+        unsigned int byte;
+        if (sscanf(hex + 2 * i, "%2x", &byte) != 1) {
+            free(data);
+            return NULL;
+        }
+        data[i] = (unsigned char)byte;
+    }
+    data[hex_len / 2] = '\0';
+
+    *len = hex_len / 2;
+    return data;
+}
+
+static void session_free(NetSession *session) {
+    free(session->key);
+    free(session->shmac);
+    free(session->sdata);
+}
+
+// Decode one stored session; expired ones were skipped by the caller
+static void load_session(SpotifyNetCache *cache, char *key_hex, char *shmac_hex, char *sdata_hex) {
+    NetSession session = {0};
+    size_t key_len;
+
+    session.key = (char *)hex_decode(key_hex, &key_len);
+    session.shmac = hex_decode(shmac_hex, &session.shmac_len);
+    session.sdata = hex_decode(sdata_hex, &session.sdata_len);
+
+    NetSession *grown = realloc(cache->sessions, sizeof(NetSession) * (cache->session_count + 1));
+    if (!session.key || !session.shmac || !session.sdata || !grown) {
+        if (grown) cache->sessions = grown;
+        session_free(&session);
+        return;
+    }
+
+    cache->sessions = grown;
+    cache->sessions[cache->session_count++] = session;
+}
+#endif
+
+// ===== LOAD =====
+
+static void load_file(SpotifyNetCache *cache) {
+    FILE *f = fopen(cache->path, "r");
+    if (!f) return;
+
+    char line[16384];
+    if (!fgets(line, sizeof(line), f) || strncmp(line, NETCACHE_MAGIC, strlen(NETCACHE_MAGIC)) != 0) {
+        fclose(f);
+        return;
+    }
+
+    time_t now = time(NULL);
+    while (fgets(line, sizeof(line), f)) {
+        line[strcspn(line, "\n")] = '\0';
+
+        NetHost host;
+        long long learned_at;
+        if (sscanf(line, "dns %255s %ld %63s %lld", host.host, &host.port, host.ip, &learned_at) == 4) {
+            host.learned_at = (time_t)learned_at;
+            if (now - host.learned_at >= SPOTIFY_NETCACHE_DNS_TTL_S) continue;
+            if (cache->host_count >= SPOTIFY_NETCACHE_MAX_HOSTS) continue;
+
+            cache->hosts[cache->host_count++] = host;
+
+            // "+" entries time out like resolved ones instead of staying forever
+            char entry[400];
+            snprintf(entry, sizeof(entry), "+%s:%ld:%s", host.host, host.port, host.ip);
+            struct curl_slist *list = curl_slist_append(cache->resolve, entry);
+            if (list) cache->resolve = list;
+
+            snprintf(entry, sizeof(entry), "-%s:%ld", host.host, host.port);
+            list = curl_slist_append(cache->purge, entry);
+            if (list) cache->purge = list;
+            continue;
+        }
+
+#ifdef NETCACHE_TLS_SESSIONS
+        long long valid_until;
+        char *fields[4];
+        int count = 0;
+        for (char *field = strtok(line, " "); field && count < 4; field = strtok(NULL, " ")) {
+            fields[count++] = field;
+        }
+        if (count == 4 && strcmp(fields[0], "tls") == 0) {
+            // tls <valid_until> <key> <shmac>:<sdata>
+            char *sdata = strchr(fields[3], ':');
+            if (sscanf(fields[1], "%lld", &valid_until) == 1 && valid_until > (long long)now && sdata) {
+                *sdata++ = '\0';
+                load_session(cache, fields[2], fields[3], sdata);
+            }
+        }
+#endif
+    }
+
+    fclose(f);
+}
+
+/**
+ * Load the stored addresses (and TLS sessions) for a pool
+ * Returns NULL when disabled by SPOTCLI_NO_CACHE or without a config directory
+ */
+SpotifyNetCache* spotify_netcache_load(void) {
+    if (getenv("SPOTCLI_NO_CACHE")) return NULL;
+
+    char dir[512];
+    if (!spotify_config_subdir("net", dir, sizeof(dir))) return NULL;
+
+    SpotifyNetCache *cache = calloc(1, sizeof(SpotifyNetCache));
+    if (!cache) return NULL;
+
+    snprintf(cache->path, sizeof(cache->path), "%s/state", dir);
+    pthread_mutex_init(&cache->lock, NULL);
+    load_file(cache);
+
+    return cache;
+}
+
+// ===== USE =====
+
+/**
+ * Seed the share of curl's pool from the stored state
+ * Handles carry the stored addresses until a transfer has run with them;
+ * the share's caches serve the rest. After a connection failure the next
+ * handle removes the entries again.
+ */
+void spotify_netcache_apply(SpotifyNetCache *cache, CURL *curl) {
+    if (!cache) return;
+
+    pthread_mutex_lock(&cache->lock);
+    if (cache->purge_pending) {
+        cache->purge_pending = false;
+        curl_easy_setopt(curl, CURLOPT_RESOLVE, cache->purge);
+    } else if (!cache->applied && cache->resolve) {
+        curl_easy_setopt(curl, CURLOPT_RESOLVE, cache->resolve);
+    }
+
+#ifdef NETCACHE_TLS_SESSIONS
+    // Imported straight into the share, so once is enough
+    if (cache->session_count > 0) {
+        for (int i = 0; i < cache->session_count; i++) {
+            NetSession *session = &cache->sessions[i];
+            curl_easy_ssls_import(curl, session->key, session->shmac, session->shmac_len,
+                                  session->sdata, session->sdata_len);
+            session_free(session);
+        }
+        free(cache->sessions);
+        cache->sessions = NULL;
+        cache->session_count = 0;
+    }
+#endif
+    pthread_mutex_unlock(&cache->lock);
+}
+
+/**
+ * Remember the address a successful transfer of curl connected to
+ */
+void spotify_netcache_learn(SpotifyNetCache *cache, CURL *curl) {
+    if (!cache) return;
+
+    char *ip = NULL;
+    char *url = NULL;
+    long port = 0;
+    curl_easy_getinfo(curl, CURLINFO_PRIMARY_IP, &ip);
+    curl_easy_getinfo(curl, CURLINFO_PRIMARY_PORT, &port);
+    curl_easy_getinfo(curl, CURLINFO_EFFECTIVE_URL, &url);
+    if (!url || !url[0] || !ip || !ip[0] || port <= 0) return;
+
+    CURLU *parsed = curl_url();
+    char *host = NULL;
+    if (!parsed || curl_url_set(parsed, CURLUPART_URL, url, 0) != CURLUE_OK ||
+        curl_url_get(parsed, CURLUPART_HOST, &host, 0) != CURLUE_OK) {
+        curl_url_cleanup(parsed);
+        return;
+    }
+
+    time_t now = time(NULL);
+    pthread_mutex_lock(&cache->lock);
+    cache->used = true;
+    cache->applied = true;
+
+    NetHost *entry = NULL;
+    for (int i = 0; i < cache->host_count; i++) {
+        if (strcmp(cache->hosts[i].host, host) == 0 && cache->hosts[i].port == port) {
+            entry = &cache->hosts[i];
+            break;
+        }
+    }
+    if (!entry && cache->host_count < SPOTIFY_NETCACHE_MAX_HOSTS) {
+        entry = &cache->hosts[cache->host_count++];
+        entry->ip[0] = '\0';
+    }
+
+    // An address served from our own "+" entry is not news; a fresh lookup is
+    if (entry && (strcmp(entry->ip, ip) != 0 || now - entry->learned_at >= SPOTIFY_NETCACHE_DNS_TTL_S)) {
+        snprintf(entry->host, sizeof(entry->host), "%s", host);
+        snprintf(entry->ip, sizeof(entry->ip), "%s", ip);
+        entry->port = port;
+        entry->learned_at = now;
+        cache->dirty = true;
+    }
+
+    pthread_mutex_unlock(&cache->lock);
+    curl_free(host);
+    curl_url_cleanup(parsed);
+}
+
+/**
+ * A transfer could not connect: the stored addresses may be stale
+ * They are dropped, the next handle removes them from the share, and the
+ * hosts are resolved again from now on
+ */
+void spotify_netcache_forget(SpotifyNetCache *cache) {
+    if (!cache) return;
+
+    pthread_mutex_lock(&cache->lock);
+    if (cache->host_count > 0) cache->dirty = true;
+    cache->host_count = 0;
+    cache->purge_pending = cache->purge != NULL;
+    cache->applied = true;
+    pthread_mutex_unlock(&cache->lock);
+}
+
+// ===== SAVE =====
+
+#ifdef NETCACHE_TLS_SESSIONS
+static CURLcode export_session(CURL *curl, void *userptr, const char *session_key,
+                               const unsigned char *shmac, size_t shmac_len,
+                               const unsigned char *sdata, size_t sdata_len,
+                               curl_off_t valid_until, int ietf_tls_id,
+                               const char *alpn, size_t earlydata_max) {
+    (void)curl;
+    (void)ietf_tls_id;
+    (void)alpn;
+    (void)earlydata_max;
+    FILE *f = userptr;
+
+    fprintf(f, "tls %lld ", (long long)valid_until);
+    hex_encode(f, (const unsigned char *)session_key, strlen(session_key));
+    fputc(' ', f);
+    hex_encode(f, shmac, shmac_len);
+    fputc(':', f);
+    hex_encode(f, sdata, sdata_len);
+    fputc('\n', f);
+
+    return CURLE_OK;
+}
+#endif
+
+/**
+ * Write the learned addresses and the share's TLS sessions back to disk
+ */
+void spotify_netcache_save(SpotifyNetCache *cache, CURLSH *share) {
+    if (!cache) return;
+
+    pthread_mutex_lock(&cache->lock);
+
+#ifdef NETCACHE_TLS_SESSIONS
+    bool changed = cache->dirty || cache->used;
+#else
+    bool changed = cache->dirty;
+#endif
+    if (!changed) {
+        pthread_mutex_unlock(&cache->lock);
+        return;
+    }
+
+    char tmp_path[704];
+    snprintf(tmp_path, sizeof(tmp_path), "%s.%ld.tmp", cache->path, (long)getpid());
+
+    // TLS session tickets are secrets, like the token
+    int fd = open(tmp_path, O_WRONLY | O_CREAT | O_TRUNC, 0600);
+    FILE *f = fd >= 0 ? fdopen(fd, "w") : NULL;
+    if (!f) {
+        if (fd >= 0) close(fd);
+        pthread_mutex_unlock(&cache->lock);
+        return;
+    }
+
+    fprintf(f, NETCACHE_MAGIC "\n");
+    for (int i = 0; i < cache->host_count; i++) {
+        const NetHost *host = &cache->hosts[i];
+        fprintf(f, "dns %s %ld %s %lld\n", host->host, host->port, host->ip, (long long)host->learned_at);
+    }
+
+#ifdef NETCACHE_TLS_SESSIONS
+    CURL *curl = share ? curl_easy_init() : NULL;
+    if (curl) {
+        curl_easy_setopt(curl, CURLOPT_SHARE, share);
+        curl_easy_ssls_export(curl, export_session, f);
+        curl_easy_cleanup(curl);
+    }
+#else
+    (void)share;
+#endif
+
+    bool ok = fclose(f) == 0;
+    if (!ok || rename(tmp_path, cache->path) != 0) {
+        unlink(tmp_path);
+    }
+
+    pthread_mutex_unlock(&cache->lock);
+}
+
+void spotify_netcache_free(SpotifyNetCache *cache) {
+    if (!cache) return;
+
+    curl_slist_free_all(cache->resolve);
+    curl_slist_free_all(cache->purge);
+#ifdef NETCACHE_TLS_SESSIONS
+    for (int i = 0; i < cache->session_count; i++) {
+        session_free(&cache->sessions[i]);
+    }
+    free(cache->sessions);
+#endif
+    pthread_mutex_destroy(&cache->lock);
+    free(cache);
+}
@@ -0,0 +1,162 @@
+#include "spotify/spotify_internal.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * Fetch the pages [start_offset, total) of an offset-paginated endpoint concurrently
+ *
+ * @param token - Valid Spotify token
+ * @param url - Endpoint URL, with or without a query string
+ * @param page_size - limit used for every page
+ * @param start_offset - Offset of the first page to fetch
+ * @param total - Total number of items reported by the first page
+ * @param sink - How page bodies are kept (SPOTIFY_LISTING_SINK for the append helpers)
+ * @param page_count - Output parameter for number of pages returned
+ * @return Array of parsed responses in offset order (free with spotify_free_pages), or NULL on error
+ */
+SpotifyResponse* spotify_fetch_pages(SpotifyToken *token, const char *url, int page_size,
+                                     int start_offset, int total, SpotifyResponseSink sink,
+                                     int *page_count) {
+    *page_count = 0;
+    if (page_size <= 0 || start_offset >= total) return NULL;
+
+    int count = (total - start_offset + page_size - 1) / page_size;
+    char separator = strchr(url, '?') ? '&' : '?';
+
+    char (*urls)[1024] = malloc(sizeof(*urls) * count);
+    SpotifyRequest *requests = calloc(count, sizeof(SpotifyRequest));
+    SpotifyResponse *responses = calloc(count, sizeof(SpotifyResponse));
+    if (!urls || !requests || !responses) {
+        free(urls);
+        free(requests);
+        free(responses);
+        return NULL;
+    }
+
+    for (int i = 0; i < count; i++) {
+        snprintf(urls[i], sizeof(urls[i]), "%s%climit=%d&offset=%d",
+                 url, separator, page_size, start_offset + i * page_size);
+
+        requests[i].method = SPOTIFY_METHOD_GET;
+        requests[i].url = urls[i];
+        requests[i].sink = sink;
+    }
+
+    int succeeded = spotify_request_batch(token, requests, count, responses, NULL, NULL, NULL);
+
+    free(requests);
+    free(urls);
+
+    // A hole in the middle would break the contiguous listing, so fail as a whole
+    if (succeeded != count) {
+        fprintf(stderr, "Failed to fetch %d of %d pages\n", count - succeeded, count);
+        spotify_free_pages(responses, count);
+        return NULL;
+    }
+
+    *page_count = count;
+    return responses;
+}
+
+void spotify_free_pages(SpotifyResponse *pages, int page_count) {
+    if (!pages) return;
+    for (int i = 0; i < page_count; i++) {
+        spotify_response_free(&pages[i]);
+    }
+    free(pages);
+}
+
+/**
+ * Get the "items" array of a page, or NULL if missing
+ */
+struct json_object* spotify_page_items(SpotifyResponse *page) {
+    struct json_object *items;
+    if (!page->json || !json_object_object_get_ex(page->json, "items", &items)) {
+        return NULL;
+    }
+    return items;
+}
+
+// Append the tracks of one json-c page
+static bool append_track_page_json(SpotifyTrack **tracks, int *count, SpotifyResponse *page,
+                                   const char *wrapper) {
+    struct json_object *items = spotify_page_items(page);
+    if (!items) return true;
+
+    int n = json_object_array_length(items);
+    SpotifyTrack *grown = spotify_mem_realloc(*tracks, sizeof(SpotifyTrack) * (*count + n));
+    if (!grown && *count + n > 0) return false;
+    *tracks = grown;
+
+    for (int i = 0; i < n; i++) {
+        struct json_object *item = json_object_array_get_idx(items, i);
+        struct json_object *track = item;
+        SpotifyTrack *slot = &(*tracks)[(*count)++];
+
+        if (wrapper && !json_object_object_get_ex(item, wrapper, &track)) {
+            track = NULL;
+        }
+
+        if (track && json_object_get_type(track) != json_type_null) {
+            parse_track_json(track, slot);
+        } else {
+            memset(slot, 0, sizeof(SpotifyTrack));
+        }
+    }
+
+    return true;
+}
+
+/**
+ * Append the tracks of every page to a track array
+ * wrapper is the key holding the track in each item ("track" for saved/playlist
+ * items) or NULL when items are tracks themselves
+ * Pages fetched with SPOTIFY_SINK_BUFFER go through the zero-DOM parser
+ */
+bool spotify_append_track_pages(SpotifyTrack **tracks, int *count, SpotifyResponse *pages,
+                                int page_count, const char *wrapper) {
+    for (int p = 0; p < page_count; p++) {
+        if (pages[p].json) {
+            if (!append_track_page_json(tracks, count, &pages[p], wrapper)) return false;
+        } else if (pages[p].body) {
+            if (fast_parse_track_items(pages[p].body, pages[p].body_size, wrapper, tracks, count) < 0) {
+                fprintf(stderr, "Failed to parse tracks page\n");
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+/**
+ * Append the playlists of every page to a playlist array
+ */
+bool spotify_append_playlist_pages(SpotifyPlaylist **playlists, int *count, SpotifyResponse *pages,
+                                   int page_count) {
+    for (int p = 0; p < page_count; p++) {
+        if (pages[p].body) {
+            if (fast_parse_playlist_items(pages[p].body, pages[p].body_size, playlists, count) < 0) {
+                fprintf(stderr, "Failed to parse playlists page\n");
+                return false;
+            }
+            continue;
+        }
+
+        struct json_object *items = spotify_page_items(&pages[p]);
+        if (!items) continue;
+
+        int n = json_object_array_length(items);
+        SpotifyPlaylist *grown = spotify_mem_realloc(*playlists, sizeof(SpotifyPlaylist) * (*count + n));
+        if (!grown && *count + n > 0) return false;
+        *playlists = grown;
+
+        for (int i = 0; i < n; i++) {
+            struct json_object *item = json_object_array_get_idx(items, i);
+            parse_playlist_json(item, &(*playlists)[(*count)++]);
+        }
+    }
+
+    return true;
+}
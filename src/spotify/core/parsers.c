@@ -111,8 +111,7 @@ void parse_artist_json(struct json_object *item, SpotifyArtist *artist) {
                     sizeof(genres_str) - strlen(genres_str) - 1);
         }
         if (genres_str[0] != '\0') {
-            strncpy(artist->genres, genres_str, sizeof(artist->genres) - 1);
-            artist->genres[sizeof(artist->genres) - 1] = '\0';
+            snprintf(artist->genres, sizeof(artist->genres), "%s", genres_str);
         }
     }
 
@@ -338,7 +337,7 @@ void parse_queue_json(struct json_object *root, SpotifyQueue *queue) {
         int count = json_object_array_length(queue_array);
 
         if (count > 0) {
-            queue->queue = malloc(sizeof(SpotifyTrack) * count);
+            queue->queue = spotify_mem_alloc(sizeof(SpotifyTrack) * count);
             if (queue->queue) {
                 queue->queue_count = count;
 
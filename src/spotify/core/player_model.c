@@ -0,0 +1,111 @@
+#include "spotify/spotify_internal.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+/**
+ * Local model of the player
+ *
+ * Between two fetches of /me/player nothing changes but the progress of a
+ * playing track, which advances with the clock. The model keeps the last
+ * fetched state anchored to the monotonic time it was reported at and
+ * extrapolates from it, so callers only need the API when the track is
+ * predicted to end, when one of our own commands changed the player, or
+ * when the drift check interval has passed (changes made from other
+ * devices are noticed at that rate).
+ */
+struct SpotifyPlayerModel {
+    char account[512];          // Refresh token (or access token) the state belongs to
+    SpotifyPlayerState state;
+    long long anchored_at;      // spotify_monotonic_ms() the state's progress_ms was true at
+    bool valid;
+    pthread_mutex_t lock;
+};
+
+SpotifyPlayerModel* spotify_player_model_new(void) {
+    SpotifyPlayerModel *model = calloc(1, sizeof(SpotifyPlayerModel));
+    if (model) pthread_mutex_init(&model->lock, NULL);
+    return model;
+}
+
+void spotify_player_model_free(SpotifyPlayerModel *model) {
+    if (!model) return;
+
+    pthread_mutex_destroy(&model->lock);
+    free(model);
+}
+
+static const char* token_account(const SpotifyToken *token) {
+    return token->refresh_token[0] ? token->refresh_token : token->access_token;
+}
+
+/**
+ * Advance a playing state's progress by elapsed_ms, without passing the track's end
+ * Returns false if the track is predicted to have ended
+ */
+bool spotify_player_state_extrapolate(SpotifyPlayerState *state, long long elapsed_ms) {
+    if (!state->is_playing || elapsed_ms <= 0) return true;
+
+    long long progress = state->progress_ms + elapsed_ms;
+    if (state->duration_ms > 0 && progress >= state->duration_ms) {
+        state->progress_ms = state->duration_ms;
+        return false;
+    }
+
+    state->progress_ms = (int)progress;
+    return true;
+}
+
+/**
+ * Predicted player state for now, if the model can answer without the API
+ * The answer counts as a cache hit in the client's stats
+ */
+bool spotify_player_model_get(const SpotifyToken *token, SpotifyPlayerState *state) {
+    SpotifyClient *client = spotify_token_client(token);
+    SpotifyPlayerModel *model = client->player;
+
+    pthread_mutex_lock(&model->lock);
+
+    long long elapsed = spotify_monotonic_ms() - model->anchored_at;
+    bool hit = model->valid &&
+               strcmp(model->account, token_account(token)) == 0 &&
+               elapsed < SPOTIFY_PLAYER_DRIFT_CHECK_MS;
+    if (hit) {
+        *state = model->state;
+        hit = spotify_player_state_extrapolate(state, elapsed);
+    }
+
+    pthread_mutex_unlock(&model->lock);
+
+    if (hit) spotify_limiter_cache_hit(client->limiter);
+    return hit;
+}
+
+/**
+ * Adopt a state fetched from /me/player
+ * anchored_at is the monotonic time the server reported it at; the middle
+ * of the request is the best estimate
+ */
+void spotify_player_model_store(const SpotifyToken *token, const SpotifyPlayerState *state,
+                                long long anchored_at) {
+    SpotifyPlayerModel *model = spotify_token_client(token)->player;
+
+    pthread_mutex_lock(&model->lock);
+    snprintf(model->account, sizeof(model->account), "%s", token_account(token));
+    model->state = *state;
+    model->anchored_at = anchored_at;
+    model->valid = true;
+    pthread_mutex_unlock(&model->lock);
+}
+
+/**
+ * Forget the modelled state after a command changed the player
+ */
+void spotify_player_model_invalidate(const SpotifyToken *token) {
+    SpotifyPlayerModel *model = spotify_token_client(token)->player;
+
+    pthread_mutex_lock(&model->lock);
+    model->valid = false;
+    pthread_mutex_unlock(&model->lock);
+}
@@ -0,0 +1,141 @@
+#include "spotify/spotify_internal.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define STORE_MAGIC "SPOTCLI-PLAYLIST 1"
+
+/**
+ * One file per playlist under ~/.config/spotCLI/playlists:
+ *   SPOTCLI-PLAYLIST 1
+ *   <snapshot_id>
+ *   <track count>
+ *   id \t uri \t duration_ms \t name \t artist \t album     (one line per track)
+ */
+
+static bool store_path(const char *playlist_id, char *path, size_t size) {
+    char dir[512];
+    if (!spotify_config_subdir("playlists", dir, sizeof(dir))) return false;
+
+    // Playlist IDs are base62, anything else is not a valid file name
+    for (const char *p = playlist_id; *p; p++) {
+        if (*p == '/' || *p == '.') return false;
+    }
+
+    int len = snprintf(path, size, "%s/%s", dir, playlist_id);
+    return len > 0 && (size_t)len < size;
+}
+
+// Tabs and newlines would break the line format
+static void write_field(FILE *f, const char *value, char separator) {
+    for (const char *p = value; *p; p++) {
+        fputc(*p == '\t' || *p == '\n' || *p == '\r' ? ' ' : *p, f);
+    }
+    fputc(separator, f);
+}
+
+// Split the next tab-separated field off *cursor into dst
+static bool read_field(char **cursor, char *dst, size_t size) {
+    if (!*cursor) return false;
+
+    char *end = strpbrk(*cursor, "\t\n");
+    size_t len = end ? (size_t)(end - *cursor) : strlen(*cursor);
+
+    size_t n = len < size - 1 ? len : size - 1;
+    memcpy(dst, *cursor, n);
+    dst[n] = '\0';
+
+    *cursor = end && *end == '\t' ? end + 1 : NULL;
+    return true;
+}
+
+bool spotify_playlist_store_load(const char *playlist_id, const char *snapshot_id,
+                                 SpotifyTrack **tracks, int *count) {
+    *tracks = NULL;
+    *count = 0;
+    if (!playlist_id || !snapshot_id || !snapshot_id[0]) return false;
+
+    char path[640];
+    if (!store_path(playlist_id, path, sizeof(path))) return false;
+
+    FILE *f = fopen(path, "r");
+    if (!f) return false;
+
+    char line[1536];
+    bool valid = fgets(line, sizeof(line), f) && strncmp(line, STORE_MAGIC, strlen(STORE_MAGIC)) == 0;
+
+    // Snapshot mismatch means the playlist changed since it was stored
+    valid = valid && fgets(line, sizeof(line), f);
+    if (valid) {
+        line[strcspn(line, "\r\n")] = '\0';
+        valid = strcmp(line, snapshot_id) == 0;
+    }
+
+    int expected = 0;
+    valid = valid && fgets(line, sizeof(line), f);
+    if (valid) {
+        expected = atoi(line);
+        valid = expected > 0;
+    }
+
+    SpotifyTrack *loaded = valid ? calloc(expected, sizeof(SpotifyTrack)) : NULL;
+    int n = 0;
+
+    while (loaded && n < expected && fgets(line, sizeof(line), f)) {
+        SpotifyTrack *track = &loaded[n];
+        char duration[16];
+        char *cursor = line;
+
+        if (!read_field(&cursor, track->id, sizeof(track->id)) ||
+            !read_field(&cursor, track->uri, sizeof(track->uri)) ||
+            !read_field(&cursor, duration, sizeof(duration)) ||
+            !read_field(&cursor, track->name, sizeof(track->name)) ||
+            !read_field(&cursor, track->artist, sizeof(track->artist)) ||
+            !read_field(&cursor, track->album, sizeof(track->album))) {
+            break;
+        }
+        track->duration_ms = atoi(duration);
+        n++;
+    }
+
+    fclose(f);
+
+    // A truncated file is as good as a miss
+    if (!loaded || n != expected) {
+        free(loaded);
+        return false;
+    }
+
+    *tracks = loaded;
+    *count = n;
+    return true;
+}
+
+void spotify_playlist_store_save(const char *playlist_id, const char *snapshot_id,
+                                 const SpotifyTrack *tracks, int count) {
+    if (!playlist_id || !snapshot_id || !snapshot_id[0] || !tracks || count <= 0) return;
+
+    char path[640];
+    char tmp_path[704];
+    if (!store_path(playlist_id, path, sizeof(path))) return;
+    snprintf(tmp_path, sizeof(tmp_path), "%s.%ld", path, (long)getpid());
+
+    FILE *f = fopen(tmp_path, "w");
+    if (!f) return;
+
+    fprintf(f, STORE_MAGIC "\n%s\n%d\n", snapshot_id, count);
+    for (int i = 0; i < count; i++) {
+        const SpotifyTrack *track = &tracks[i];
+        write_field(f, track->id, '\t');
+        write_field(f, track->uri, '\t');
+        fprintf(f, "%d\t", track->duration_ms);
+        write_field(f, track->name, '\t');
+        write_field(f, track->artist, '\t');
+        write_field(f, track->album, '\n');
+    }
+
+    if (fclose(f) != 0 || rename(tmp_path, path) != 0) {
+        unlink(tmp_path);
+    }
+}
@@ -0,0 +1,199 @@
+#include "spotify/spotify_internal.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <curl/curl.h>
+
+struct SpotifyPool {
+    CURLSH *share;
+    CURL *handles[SPOTIFY_POOL_SIZE];
+    bool in_use[SPOTIFY_POOL_SIZE];
+    pthread_mutex_t lock;
+    pthread_mutex_t share_locks[CURL_LOCK_DATA_LAST];
+    SpotifyNetCache *net;           // Addresses and TLS sessions from earlier runs
+};
+
+static pthread_once_t global_once = PTHREAD_ONCE_INIT;
+
+// ===== SHARE LOCKING =====
+
+static void share_lock(CURL *handle, curl_lock_data data, curl_lock_access access, void *userp) {
+    (void)handle;
+    (void)access;
+    SpotifyPool *pool = userp;
+    pthread_mutex_lock(&pool->share_locks[data]);
+}
+
+static void share_unlock(CURL *handle, curl_lock_data data, void *userp) {
+    (void)handle;
+    SpotifyPool *pool = userp;
+    pthread_mutex_unlock(&pool->share_locks[data]);
+}
+
+static void global_init(void) {
+    curl_global_init(CURL_GLOBAL_DEFAULT);
+}
+
+// Options every pooled handle gets after a reset
+static void pool_prepare_handle(SpotifyPool *pool, CURL *curl) {
+    if (pool->share) {
+        curl_easy_setopt(curl, CURLOPT_SHARE, pool->share);
+    }
+    curl_easy_setopt(curl, CURLOPT_HTTP_VERSION, (long)CURL_HTTP_VERSION_2TLS);
+    curl_easy_setopt(curl, CURLOPT_TCP_KEEPALIVE, 1L);
+    curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);
+    curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT_MS, (long)SPOTIFY_CONNECT_TIMEOUT_MS);
+    spotify_netcache_apply(pool->net, curl);
+}
+
+// ===== PUBLIC FUNCTIONS =====
+
+/**
+ * Create a pool with its own DNS/TLS session/connection cache
+ * Each SpotifyClient owns one
+ */
+SpotifyPool* spotify_pool_new(void) {
+    pthread_once(&global_once, global_init);
+
+    SpotifyPool *pool = calloc(1, sizeof(SpotifyPool));
+    if (!pool) return NULL;
+
+    pthread_mutex_init(&pool->lock, NULL);
+    for (int i = 0; i < CURL_LOCK_DATA_LAST; i++) {
+        pthread_mutex_init(&pool->share_locks[i], NULL);
+    }
+
+    pool->share = curl_share_init();
+    if (pool->share) {
+        curl_share_setopt(pool->share, CURLSHOPT_LOCKFUNC, share_lock);
+        curl_share_setopt(pool->share, CURLSHOPT_UNLOCKFUNC, share_unlock);
+        curl_share_setopt(pool->share, CURLSHOPT_USERDATA, pool);
+        curl_share_setopt(pool->share, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+        curl_share_setopt(pool->share, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+        curl_share_setopt(pool->share, CURLSHOPT_SHARE, CURL_LOCK_DATA_CONNECT);
+        pool->net = spotify_netcache_load();
+    }
+
+    return pool;
+}
+
+/**
+ * Borrow an easy handle from the pool
+ * The handle is reset but keeps its connection cache, so the next request
+ * to api.spotify.com reuses the already established TLS connection.
+ * Without a pool (the default client's after exit) a standalone handle is returned.
+ */
+CURL* spotify_pool_acquire(SpotifyPool *pool) {
+    if (!pool) return curl_easy_init();
+
+    CURL *curl = NULL;
+
+    pthread_mutex_lock(&pool->lock);
+    for (int i = 0; i < SPOTIFY_POOL_SIZE; i++) {
+        if (pool->in_use[i]) continue;
+
+        if (!pool->handles[i]) {
+            pool->handles[i] = curl_easy_init();
+            if (!pool->handles[i]) break;
+        } else {
+            curl_easy_reset(pool->handles[i]);
+        }
+
+        pool->in_use[i] = true;
+        curl = pool->handles[i];
+        break;
+    }
+    pthread_mutex_unlock(&pool->lock);
+
+    // Pool exhausted: hand out a transient handle that still uses the share
+    if (!curl) {
+        curl = curl_easy_init();
+        if (!curl) return NULL;
+    }
+
+    pool_prepare_handle(pool, curl);
+    return curl;
+}
+
+/**
+ * Return a handle obtained with spotify_pool_acquire()
+ */
+void spotify_pool_release(SpotifyPool *pool, CURL *curl) {
+    if (!curl) return;
+    if (!pool) {
+        curl_easy_cleanup(curl);
+        return;
+    }
+
+    pthread_mutex_lock(&pool->lock);
+    for (int i = 0; i < SPOTIFY_POOL_SIZE; i++) {
+        if (pool->handles[i] == curl) {
+            pool->in_use[i] = false;
+            pthread_mutex_unlock(&pool->lock);
+            return;
+        }
+    }
+    pthread_mutex_unlock(&pool->lock);
+
+    // Transient handle, not owned by the pool
+    curl_easy_cleanup(curl);
+}
+
+/**
+ * Report how a transfer on a handle of the pool ended
+ * The network cache learns the address a successful transfer connected to,
+ * and forgets the stored addresses when a connection could not be made.
+ * Handles released without a transfer are never reported.
+ */
+void spotify_pool_transfer_done(SpotifyPool *pool, CURL *curl, CURLcode res) {
+    if (!pool) return;
+
+    if (res == CURLE_OK) {
+        spotify_netcache_learn(pool->net, curl);
+        return;
+    }
+
+    curl_off_t connect_time = 0;
+    curl_easy_getinfo(curl, CURLINFO_CONNECT_TIME_T, &connect_time);
+    if (res == CURLE_COULDNT_CONNECT ||
+        (res == CURLE_OPERATION_TIMEDOUT && connect_time == 0)) {
+        spotify_netcache_forget(pool->net);
+    }
+}
+
+/**
+ * Get the share handle (DNS, TLS sessions, connections) used by the pool
+ */
+CURLSH* spotify_pool_share(SpotifyPool *pool) {
+    return pool->share;
+}
+
+/**
+ * Close every pooled handle and the share handle, persisting what the
+ * network cache learned
+ * No handle of the pool may be in use
+ */
+void spotify_pool_free(SpotifyPool *pool) {
+    if (!pool) return;
+
+    for (int i = 0; i < SPOTIFY_POOL_SIZE; i++) {
+        if (pool->handles[i]) {
+            curl_easy_cleanup(pool->handles[i]);
+        }
+    }
+
+    // Sessions are exported from the share, so save before it goes away
+    spotify_netcache_save(pool->net, pool->share);
+    spotify_netcache_free(pool->net);
+
+    if (pool->share) {
+        curl_share_cleanup(pool->share);
+    }
+
+    pthread_mutex_destroy(&pool->lock);
+    for (int i = 0; i < CURL_LOCK_DATA_LAST; i++) {
+        pthread_mutex_destroy(&pool->share_locks[i]);
+    }
+    free(pool);
+}
@@ -0,0 +1,130 @@
+#include "spotify/spotify_internal.h"
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+
+/**
+ * Client-side rate limiting shared by every request
+ *
+ * A token bucket spreads requests over time, and a 429 pauses its request
+ * class until Retry-After has passed. Throttling also empties the bucket so
+ * the other classes slow down together instead of piling onto the limit.
+ */
+typedef struct {
+    double tokens;
+    long long refilled_at;
+    long long paused_until[SPOTIFY_CLASS_COUNT];
+    pthread_mutex_t lock;
+} SpotifyRateLimiter;
+
+static SpotifyRateLimiter limiter = {
+    .tokens = SPOTIFY_RATELIMIT_BURST,
+    .lock = PTHREAD_MUTEX_INITIALIZER
+};
+
+long long spotify_monotonic_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+void spotify_sleep_ms(long ms) {
+    if (ms <= 0) return;
+
+    struct timespec ts = { ms / 1000, (ms % 1000) * 1000000L };
+    while (nanosleep(&ts, &ts) != 0) {
+        // Interrupted by a signal, sleep for the remainder
+    }
+}
+
+/**
+ * Classify a request by the part of the API it touches
+ * Spotify throttles per application, but pausing only the class that hit the
+ * limit keeps playback controls responsive during a bulk library job.
+ */
+SpotifyRequestClass spotify_request_class(const SpotifyRequest *request) {
+    const char *path = strstr(request->url, "/v1/");
+    if (!path) return SPOTIFY_CLASS_CATALOG;
+    path += 3;
+
+    if (strncmp(path, "/me/player", 10) == 0) return SPOTIFY_CLASS_PLAYER;
+    if (strstr(path, "/playlists")) return SPOTIFY_CLASS_PLAYLIST;
+    if (strncmp(path, "/me", 3) == 0) return SPOTIFY_CLASS_LIBRARY;
+    return SPOTIFY_CLASS_CATALOG;
+}
+
+static void refill(long long now) {
+    if (limiter.refilled_at == 0) limiter.refilled_at = now;
+
+    double elapsed = (now - limiter.refilled_at) / 1000.0;
+    limiter.tokens += elapsed * SPOTIFY_RATELIMIT_RATE;
+    if (limiter.tokens > SPOTIFY_RATELIMIT_BURST) limiter.tokens = SPOTIFY_RATELIMIT_BURST;
+    limiter.refilled_at = now;
+}
+
+/**
+ * Try to take a token for a request of the given class
+ * Returns 0 if the request may start now, otherwise the milliseconds to wait
+ */
+long spotify_ratelimit_reserve(SpotifyRequestClass cls) {
+    long long now = spotify_monotonic_ms();
+    long wait = 0;
+
+    pthread_mutex_lock(&limiter.lock);
+
+    if (limiter.paused_until[cls] > now) {
+        wait = (long)(limiter.paused_until[cls] - now);
+    } else {
+        refill(now);
+        if (limiter.tokens >= 1.0) {
+            limiter.tokens -= 1.0;
+        } else {
+            wait = (long)((1.0 - limiter.tokens) * 1000.0 / SPOTIFY_RATELIMIT_RATE) + 1;
+        }
+    }
+
+    pthread_mutex_unlock(&limiter.lock);
+    return wait;
+}
+
+/**
+ * Block until a request of the given class may start
+ *
+ * @param deadline - Absolute deadline of the request
+ * @param extend - Push deadline back by the time spent waiting, so a
+ *                 Retry-After pause does not eat into the transfer budget
+ * @return false, without waiting, if the wait would pass the deadline (or
+ *         SPOTIFY_RATELIMIT_MAX_WAIT_MS when extending)
+ */
+bool spotify_ratelimit_acquire(SpotifyRequestClass cls, long long *deadline, bool extend) {
+    long wait;
+    while ((wait = spotify_ratelimit_reserve(cls)) > 0) {
+        if (wait > SPOTIFY_RATELIMIT_MAX_WAIT_MS) return false;
+        if (!extend && spotify_monotonic_ms() + wait >= *deadline) return false;
+
+        spotify_sleep_ms(wait);
+        if (extend) *deadline += wait;
+    }
+    return true;
+}
+
+/**
+ * Record a 429 for the given class
+ *
+ * @param retry_after - Seconds from the Retry-After header (0 if absent)
+ */
+void spotify_ratelimit_throttled(SpotifyRequestClass cls, long retry_after) {
+    if (retry_after <= 0) retry_after = SPOTIFY_RATELIMIT_DEFAULT_PAUSE;
+
+    long long until = spotify_monotonic_ms() + retry_after * 1000;
+
+    pthread_mutex_lock(&limiter.lock);
+    if (until > limiter.paused_until[cls]) {
+        limiter.paused_until[cls] = until;
+    }
+    limiter.tokens = 0;
+    pthread_mutex_unlock(&limiter.lock);
+
+    fprintf(stderr, "Rate limited by Spotify, pausing for %lds\n", retry_after);
+}
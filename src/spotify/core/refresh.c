@@ -0,0 +1,209 @@
+#include "spotify/spotify_internal.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+
+/**
+ * Access token refresh for a client
+ *
+ * The generation counts completed refreshes. A request remembers the
+ * generation it was sent with; when it gets a 401 it asks for a refresh
+ * of that generation, which is a no-op if another request already
+ * replaced the token in the meantime. The token endpoint is called
+ * without holding the lock, on a copy of the token, so requests keep
+ * reading the old token until the new one is swapped in.
+ */
+struct SpotifyTokenRefresh {
+    pthread_mutex_t lock;
+    pthread_cond_t cond;        // Signalled when a refresh finishes or the refresher must stop
+    unsigned generation;
+    bool refreshing;
+
+    // Background refresher
+    SpotifyToken *target;
+    pthread_t thread;
+    bool running;
+    bool stopping;
+};
+
+SpotifyTokenRefresh* spotify_token_refresh_new(void) {
+    SpotifyTokenRefresh *refresh = calloc(1, sizeof(SpotifyTokenRefresh));
+    if (!refresh) return NULL;
+
+    pthread_mutex_init(&refresh->lock, NULL);
+    pthread_cond_init(&refresh->cond, NULL);
+    return refresh;
+}
+
+/**
+ * Stop the background refresher and wait for it, including a refresh it is
+ * running; the token can still be refreshed on demand afterwards
+ */
+void spotify_token_refresh_stop(SpotifyTokenRefresh *refresh) {
+    if (!refresh) return;
+
+    pthread_mutex_lock(&refresh->lock);
+    bool running = refresh->running;
+    refresh->stopping = true;
+    refresh->running = false;
+    pthread_cond_broadcast(&refresh->cond);
+    pthread_mutex_unlock(&refresh->lock);
+
+    if (running) pthread_join(refresh->thread, NULL);
+}
+
+/**
+ * Stop the background refresher and free refresh
+ */
+void spotify_token_refresh_free(SpotifyTokenRefresh *refresh) {
+    if (!refresh) return;
+
+    spotify_token_refresh_stop(refresh);
+
+    pthread_cond_destroy(&refresh->cond);
+    pthread_mutex_destroy(&refresh->lock);
+    free(refresh);
+}
+
+static SpotifyTokenRefresh* token_refresh(const SpotifyToken *token) {
+    return spotify_token_client(token)->refresh;
+}
+
+/**
+ * Copy the current access token
+ */
+void spotify_token_bearer(const SpotifyToken *token, char *access_token, size_t size) {
+    SpotifyTokenRefresh *refresh = token_refresh(token);
+
+    pthread_mutex_lock(&refresh->lock);
+    snprintf(access_token, size, "%s", token->access_token);
+    pthread_mutex_unlock(&refresh->lock);
+}
+
+/**
+ * Generation of the current access token, to pass to spotify_token_refresh()
+ * if a request sent with it is rejected
+ */
+unsigned spotify_token_generation(const SpotifyToken *token) {
+    SpotifyTokenRefresh *refresh = token_refresh(token);
+
+    pthread_mutex_lock(&refresh->lock);
+    unsigned generation = refresh->generation;
+    pthread_mutex_unlock(&refresh->lock);
+
+    return generation;
+}
+
+/**
+ * Replace the access token of the given generation
+ *
+ * Callers that arrive while a refresh is running wait for it and share its
+ * outcome; callers whose generation was already replaced return at once.
+ *
+ * @return true if the token is newer than generation afterwards
+ */
+bool spotify_token_refresh(SpotifyToken *token, unsigned generation) {
+    SpotifyTokenRefresh *refresh = token_refresh(token);
+
+    pthread_mutex_lock(&refresh->lock);
+
+    if (refresh->refreshing) {
+        while (refresh->refreshing) {
+            pthread_cond_wait(&refresh->cond, &refresh->lock);
+        }
+        bool replaced = refresh->generation != generation;
+        pthread_mutex_unlock(&refresh->lock);
+        return replaced;
+    }
+
+    if (refresh->generation != generation) {
+        pthread_mutex_unlock(&refresh->lock);
+        return true;
+    }
+
+    refresh->refreshing = true;
+    SpotifyToken fresh = *token;
+    pthread_mutex_unlock(&refresh->lock);
+
+    bool ok = spotify_refresh_token(&fresh);
+
+    pthread_mutex_lock(&refresh->lock);
+    if (ok) {
+        memcpy(token->access_token, fresh.access_token, sizeof(token->access_token));
+        memcpy(token->refresh_token, fresh.refresh_token, sizeof(token->refresh_token));
+        token->expires_in = fresh.expires_in;
+        token->obtained_at = fresh.obtained_at;
+        refresh->generation++;
+    } else {
+        fprintf(stderr, "Failed to refresh access token\n");
+    }
+    refresh->refreshing = false;
+    pthread_cond_broadcast(&refresh->cond);
+    pthread_mutex_unlock(&refresh->lock);
+
+    return ok;
+}
+
+// ===== BACKGROUND REFRESHER =====
+
+// Sleep until the target token is due (lock held), refresh it, repeat
+static void* refresher_main(void *arg) {
+    SpotifyTokenRefresh *refresh = arg;
+    SpotifyToken *token = refresh->target;
+    time_t retry_at = 0;
+
+    pthread_mutex_lock(&refresh->lock);
+    while (!refresh->stopping) {
+        time_t due = token->obtained_at + token->expires_in - SPOTIFY_TOKEN_REFRESH_MARGIN_S;
+        if (retry_at > due) due = retry_at;
+
+        if (time(NULL) < due) {
+            struct timespec until = { .tv_sec = due, .tv_nsec = 0 };
+            pthread_cond_timedwait(&refresh->cond, &refresh->lock, &until);
+            continue;
+        }
+
+        unsigned generation = refresh->generation;
+        pthread_mutex_unlock(&refresh->lock);
+
+        bool ok = spotify_token_refresh(token, generation);
+
+        pthread_mutex_lock(&refresh->lock);
+        retry_at = ok ? 0 : time(NULL) + SPOTIFY_TOKEN_RETRY_S;
+    }
+    pthread_mutex_unlock(&refresh->lock);
+
+    return NULL;
+}
+
+/**
+ * Keep token valid from a background thread, refreshing it shortly before it
+ * expires, so requests never wait for the token endpoint
+ *
+ * token must stay valid until its client is freed (for the default client,
+ * until the process exits). One token per client is kept fresh; further
+ * calls for the same client are ignored.
+ */
+bool spotify_token_keep_fresh(SpotifyToken *token) {
+    if (!token) return false;
+    SpotifyTokenRefresh *refresh = token_refresh(token);
+
+    pthread_mutex_lock(&refresh->lock);
+    if (refresh->running || refresh->stopping) {
+        bool running = refresh->running;
+        pthread_mutex_unlock(&refresh->lock);
+        return running;
+    }
+
+    refresh->target = token;
+    refresh->running = pthread_create(&refresh->thread, NULL, refresher_main, refresh) == 0;
+    bool running = refresh->running;
+    pthread_mutex_unlock(&refresh->lock);
+
+    if (!running) {
+        fprintf(stderr, "Failed to start token refresher\n");
+    }
+    return running;
+}
@@ -0,0 +1,86 @@
+#include "spotify/spotify_internal.h"
+#include <stdlib.h>
+#include <stdint.h>
+
+/**
+ * Retry policy of the request engine
+ *
+ * Transient failures (connection errors, timeouts, 5xx) are retried with
+ * jittered exponential backoff, but only for requests that are safe to send
+ * twice: GET, PUT and DELETE by default. A POST may have been applied before
+ * the failure, so it is never retried blindly; callers that can prove it was
+ * not applied (see spotify_add_tracks_to_playlist) retry it themselves.
+ * A 429 is always safe to resend since the request was rejected unprocessed.
+ */
+
+/**
+ * Returns true if the failure may go away by itself
+ */
+bool spotify_retry_transient(const SpotifyResponse *response) {
+    switch (response->curl_code) {
+        case CURLE_OK:
+            break;
+        case CURLE_COULDNT_RESOLVE_HOST:
+        case CURLE_COULDNT_CONNECT:
+        case CURLE_OPERATION_TIMEDOUT:
+        case CURLE_SSL_CONNECT_ERROR:
+        case CURLE_SEND_ERROR:
+        case CURLE_RECV_ERROR:
+        case CURLE_GOT_NOTHING:
+        case CURLE_PARTIAL_FILE:
+        case CURLE_HTTP2:
+        case CURLE_HTTP2_STREAM:
+            return true;
+        default:
+            return false;
+    }
+
+    return response->status == 500 || response->status == 502 ||
+           response->status == 503 || response->status == 504;
+}
+
+static bool retry_allowed(const SpotifyRequest *request) {
+    switch (request->retry) {
+        case SPOTIFY_RETRY_NEVER:
+            return false;
+        case SPOTIFY_RETRY_ALWAYS:
+            return true;
+        case SPOTIFY_RETRY_BY_METHOD:
+            break;
+    }
+    return request->method != SPOTIFY_METHOD_POST;
+}
+
+/**
+ * "Full jitter" backoff: a uniform delay in [0, min(cap, base * 2^attempt)]
+ * Spreads out clients that failed at the same moment
+ */
+long spotify_retry_backoff_ms(int attempt) {
+    static __thread unsigned int seed = 0;
+    if (seed == 0) {
+        seed = (unsigned int)spotify_monotonic_ms() ^ (unsigned int)(uintptr_t)&seed;
+    }
+
+    long ceiling = SPOTIFY_RETRY_BASE_MS;
+    for (int i = 0; i < attempt && ceiling < SPOTIFY_RETRY_CAP_MS; i++) {
+        ceiling *= 2;
+    }
+    if (ceiling > SPOTIFY_RETRY_CAP_MS) ceiling = SPOTIFY_RETRY_CAP_MS;
+
+    return (long)(rand_r(&seed) % (ceiling + 1));
+}
+
+/**
+ * Decide whether a failed attempt is sent again
+ *
+ * @param attempt - Number of the attempt that failed, starting at 0
+ * @return Delay in milliseconds before resending, or -1 to give up
+ *         (0 for a 429, where the rate limiter holds the request back)
+ */
+long spotify_retry_delay(const SpotifyRequest *request, const SpotifyResponse *response, int attempt) {
+    if (attempt >= SPOTIFY_RETRY_MAX_ATTEMPTS) return -1;
+    if (response->status == 429) return 0;
+    if (!retry_allowed(request) || !spotify_retry_transient(response)) return -1;
+
+    return spotify_retry_backoff_ms(attempt);
+}
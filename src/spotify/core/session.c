@@ -0,0 +1,261 @@
+#include "spotify/spotify_internal.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+/**
+ * Session memo for data that only changes when we change it
+ *
+ * The current user's id (GET /me) and pages of the user's playlist list
+ * (GET /me/playlists) are kept for the session, keyed by the account's
+ * token. Our own playlist mutations drop the playlist pages; a TTL bounds
+ * how long changes made from other clients go unnoticed.
+ *
+ * The snapshot_id each of our mutations returned is kept too, so the next
+ * change to the same playlist knows its starting snapshot without asking.
+ */
+
+typedef struct {
+    int limit;
+    int offset;
+    SpotifyPlaylist *playlists;
+    int count;
+    int total;
+    long long stored_at;
+} MemoPlaylistPage;
+
+typedef struct {
+    char playlist_id[64];
+    char snapshot_id[128];
+    long long stored_at;
+} MemoSnapshot;
+
+struct SpotifySession {
+    char account[512];              // Refresh token (or access token) the memo belongs to
+    char user_id[64];
+    long long user_stored_at;
+    MemoPlaylistPage pages[SPOTIFY_SESSION_MAX_PAGES];
+    int page_count;
+    MemoSnapshot snapshots[SPOTIFY_SESSION_MAX_SNAPSHOTS];
+    int snapshot_count;
+    pthread_mutex_t lock;
+};
+
+SpotifySession* spotify_session_new(void) {
+    SpotifySession *session = calloc(1, sizeof(SpotifySession));
+    if (session) pthread_mutex_init(&session->lock, NULL);
+    return session;
+}
+
+static bool fresh(long long stored_at) {
+    return stored_at > 0 && spotify_monotonic_ms() - stored_at < SPOTIFY_SESSION_TTL_MS;
+}
+
+static void clear_pages(SpotifySession *session) {
+    for (int i = 0; i < session->page_count; i++) {
+        free(session->pages[i].playlists);
+    }
+    session->page_count = 0;
+}
+
+static MemoSnapshot* find_snapshot(SpotifySession *session, const char *playlist_id) {
+    for (int i = 0; i < session->snapshot_count; i++) {
+        if (strcmp(session->snapshots[i].playlist_id, playlist_id) == 0) {
+            return &session->snapshots[i];
+        }
+    }
+    return NULL;
+}
+
+void spotify_session_free(SpotifySession *session) {
+    if (!session) return;
+
+    clear_pages(session);
+    pthread_mutex_destroy(&session->lock);
+    free(session);
+}
+
+/**
+ * Switch the memo to token's account, dropping what belonged to another one
+ * Must be called with the lock held
+ */
+static void select_account(SpotifySession *session, const SpotifyToken *token) {
+    const char *account = token->refresh_token[0] ? token->refresh_token : token->access_token;
+    if (strcmp(session->account, account) == 0) return;
+
+    clear_pages(session);
+    session->snapshot_count = 0;
+    session->user_id[0] = '\0';
+    session->user_stored_at = 0;
+    snprintf(session->account, sizeof(session->account), "%s", account);
+}
+
+// ===== CURRENT USER =====
+
+bool spotify_session_user_id(const SpotifyToken *token, char *user_id, size_t size) {
+    SpotifySession *session = spotify_token_client(token)->session;
+
+    pthread_mutex_lock(&session->lock);
+    select_account(session, token);
+
+    bool hit = session->user_id[0] && fresh(session->user_stored_at);
+    if (hit) snprintf(user_id, size, "%s", session->user_id);
+
+    pthread_mutex_unlock(&session->lock);
+    return hit;
+}
+
+void spotify_session_store_user_id(const SpotifyToken *token, const char *user_id) {
+    SpotifySession *session = spotify_token_client(token)->session;
+
+    pthread_mutex_lock(&session->lock);
+    select_account(session, token);
+
+    snprintf(session->user_id, sizeof(session->user_id), "%s", user_id);
+    session->user_stored_at = spotify_monotonic_ms();
+
+    pthread_mutex_unlock(&session->lock);
+}
+
+// ===== PLAYLIST PAGES =====
+
+/**
+ * Copy of a memoized page of the user's playlists, or NULL
+ * Free with spotify_free_playlist_list()
+ */
+SpotifyPlaylistList* spotify_session_playlists(const SpotifyToken *token, int limit, int offset) {
+    SpotifyPlaylistList *list = NULL;
+
+    SpotifySession *session = spotify_token_client(token)->session;
+
+    pthread_mutex_lock(&session->lock);
+    select_account(session, token);
+
+    for (int i = 0; i < session->page_count; i++) {
+        MemoPlaylistPage *page = &session->pages[i];
+        if (page->limit != limit || page->offset != offset || !fresh(page->stored_at)) continue;
+
+        list = spotify_mem_alloc(sizeof(SpotifyPlaylistList));
+        SpotifyPlaylist *playlists = spotify_mem_alloc(sizeof(SpotifyPlaylist) * (page->count ? page->count : 1));
+        if (!list || !playlists) {
+            spotify_mem_free(list);
+            spotify_mem_free(playlists);
+            list = NULL;
+            break;
+        }
+
+        memcpy(playlists, page->playlists, sizeof(SpotifyPlaylist) * page->count);
+        list->playlists = playlists;
+        list->count = page->count;
+        list->total = page->total;
+        break;
+    }
+
+    pthread_mutex_unlock(&session->lock);
+    return list;
+}
+
+void spotify_session_store_playlists(const SpotifyToken *token, int limit, int offset,
+                                     const SpotifyPlaylistList *list) {
+    SpotifyPlaylist *copy = malloc(sizeof(SpotifyPlaylist) * (list->count ? list->count : 1));
+    if (!copy) return;
+    memcpy(copy, list->playlists, sizeof(SpotifyPlaylist) * list->count);
+
+    SpotifySession *session = spotify_token_client(token)->session;
+
+    pthread_mutex_lock(&session->lock);
+    select_account(session, token);
+
+    // Replace the same page, or evict the oldest when full
+    MemoPlaylistPage *slot = NULL;
+    for (int i = 0; i < session->page_count; i++) {
+        MemoPlaylistPage *page = &session->pages[i];
+        if (page->limit == limit && page->offset == offset) {
+            slot = page;
+            break;
+        }
+        if (session->page_count == SPOTIFY_SESSION_MAX_PAGES &&
+            (!slot || page->stored_at < slot->stored_at)) {
+            slot = page;
+        }
+    }
+    if (!slot) slot = &session->pages[session->page_count++];
+
+    free(slot->playlists);
+    slot->limit = limit;
+    slot->offset = offset;
+    slot->playlists = copy;
+    slot->count = list->count;
+    slot->total = list->total;
+    slot->stored_at = spotify_monotonic_ms();
+
+    pthread_mutex_unlock(&session->lock);
+}
+
+/**
+ * Drop memoized playlist pages after creating, updating or unfollowing a
+ * playlist, or changing its tracks
+ */
+void spotify_session_invalidate_playlists(const SpotifyToken *token) {
+    SpotifySession *session = spotify_token_client(token)->session;
+
+    pthread_mutex_lock(&session->lock);
+    clear_pages(session);
+    pthread_mutex_unlock(&session->lock);
+}
+
+// ===== PLAYLIST SNAPSHOTS =====
+
+/**
+ * snapshot_id our last change to playlist_id left it at, if still fresh
+ */
+bool spotify_session_playlist_snapshot(const SpotifyToken *token, const char *playlist_id,
+                                       char *snapshot, size_t size) {
+    SpotifySession *session = spotify_token_client(token)->session;
+
+    pthread_mutex_lock(&session->lock);
+    select_account(session, token);
+
+    MemoSnapshot *memo = find_snapshot(session, playlist_id);
+    bool hit = memo && fresh(memo->stored_at);
+    if (hit) snprintf(snapshot, size, "%s", memo->snapshot_id);
+
+    pthread_mutex_unlock(&session->lock);
+    return hit;
+}
+
+/**
+ * Remember the snapshot_id a change to playlist_id returned
+ * An empty snapshot forgets the playlist's entry
+ */
+void spotify_session_store_playlist_snapshot(const SpotifyToken *token, const char *playlist_id,
+                                             const char *snapshot) {
+    SpotifySession *session = spotify_token_client(token)->session;
+
+    pthread_mutex_lock(&session->lock);
+    select_account(session, token);
+
+    MemoSnapshot *slot = find_snapshot(session, playlist_id);
+    if (!snapshot[0]) {
+        if (slot) *slot = session->snapshots[--session->snapshot_count];
+        pthread_mutex_unlock(&session->lock);
+        return;
+    }
+
+    // Take a free entry, or evict the oldest when full
+    if (!slot && session->snapshot_count < SPOTIFY_SESSION_MAX_SNAPSHOTS) {
+        slot = &session->snapshots[session->snapshot_count++];
+    } else if (!slot) {
+        slot = &session->snapshots[0];
+        for (int i = 1; i < session->snapshot_count; i++) {
+            if (session->snapshots[i].stored_at < slot->stored_at) slot = &session->snapshots[i];
+        }
+    }
+
+    snprintf(slot->playlist_id, sizeof(slot->playlist_id), "%s", playlist_id);
+    snprintf(slot->snapshot_id, sizeof(slot->snapshot_id), "%s", snapshot);
+    slot->stored_at = spotify_monotonic_ms();
+
+    pthread_mutex_unlock(&session->lock);
+}
@@ -0,0 +1,170 @@
+#include "spotify/spotify_internal.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+/**
+ * Single-flight coalescing of identical GET requests
+ *
+ * While a GET for some URL and token is in flight, identical GETs from other
+ * threads wait for it instead of going to the network, and all of them get
+ * the same parsed result. The leader takes one json-c reference per waiting
+ * caller before it wakes them up, so afterwards every caller owns its own
+ * reference and releases it with spotify_response_free() as usual. The
+ * shared tree must be treated as read-only; note that json-c caches the
+ * output of json_object_to_json_string() inside the object, so that call
+ * counts as a write.
+ */
+struct SpotifyFlight {
+    char *key;                  // "<access token>\n<url>"
+    bool done;
+    int waiters;                // Callers blocked on this flight, not counting the leader
+
+    // Outcome, published by the leader
+    bool ok;
+    long status;
+    CURLcode curl_code;
+    struct json_object *json;
+    char *body;
+    size_t body_size;
+
+    pthread_cond_t cond;
+    struct SpotifyFlight *next;
+};
+
+static SpotifyFlight *flights = NULL;
+static pthread_mutex_t flights_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static bool coalescable(const SpotifyRequest *request) {
+    return request->method == SPOTIFY_METHOD_GET && !request->bypass_cache &&
+           (request->sink == SPOTIFY_SINK_JSON || request->sink == SPOTIFY_SINK_BUFFER);
+}
+
+static char* flight_key(const SpotifyToken *token, const SpotifyRequest *request) {
+    char access_token[sizeof(token->access_token)];
+    spotify_token_bearer(token, access_token, sizeof(access_token));
+
+    size_t size = strlen(access_token) + strlen(request->url) + 2;
+    char *key = malloc(size);
+    if (key) snprintf(key, size, "%s\n%s", access_token, request->url);
+    return key;
+}
+
+static void flight_free(SpotifyFlight *flight) {
+    pthread_cond_destroy(&flight->cond);
+    free(flight->key);
+    free(flight->body);
+    free(flight);
+}
+
+/**
+ * Join an identical in-flight request, or become the leader for this one
+ *
+ * @return true if another caller's request answered this one: response is
+ *         filled and *ok holds its outcome. Otherwise the caller performs the
+ *         request itself and passes *flight (NULL when the request is not
+ *         coalesced) to spotify_singleflight_end().
+ */
+bool spotify_singleflight_join(const SpotifyToken *token, const SpotifyRequest *request,
+                               SpotifyResponse *response, bool *ok, SpotifyFlight **flight) {
+    *flight = NULL;
+    if (!coalescable(request)) return false;
+
+    char *key = flight_key(token, request);
+    if (!key) return false;
+
+    pthread_mutex_lock(&flights_lock);
+
+    SpotifyFlight *current = flights;
+    while (current && strcmp(current->key, key) != 0) {
+        current = current->next;
+    }
+
+    // Nobody is fetching this yet: lead
+    if (!current) {
+        SpotifyFlight *created = calloc(1, sizeof(SpotifyFlight));
+        if (created) {
+            created->key = key;
+            pthread_cond_init(&created->cond, NULL);
+            created->next = flights;
+            flights = created;
+            *flight = created;
+        } else {
+            free(key);
+        }
+        pthread_mutex_unlock(&flights_lock);
+        return false;
+    }
+
+    free(key);
+    current->waiters++;
+    while (!current->done) {
+        pthread_cond_wait(&current->cond, &flights_lock);
+    }
+
+    // The leader took a reference for each waiter
+    response->status = current->status;
+    response->curl_code = current->curl_code;
+    response->json = current->json;
+    if (current->body) {
+        response->body = malloc(current->body_size + 1);
+        if (response->body) {
+            memcpy(response->body, current->body, current->body_size + 1);
+            response->body_size = current->body_size;
+        }
+    }
+    *ok = current->ok && (!current->body || response->body);
+
+    bool last = --current->waiters == 0;
+    pthread_mutex_unlock(&flights_lock);
+
+    if (last) flight_free(current);
+    return true;
+}
+
+/**
+ * Publish the leader's outcome to the callers waiting on flight
+ */
+void spotify_singleflight_end(SpotifyFlight *flight, const SpotifyResponse *response, bool ok) {
+    if (!flight) return;
+
+    pthread_mutex_lock(&flights_lock);
+
+    for (SpotifyFlight **link = &flights; *link; link = &(*link)->next) {
+        if (*link == flight) {
+            *link = flight->next;
+            break;
+        }
+    }
+
+    bool shared = flight->waiters > 0;
+    if (shared) {
+        flight->ok = ok;
+        flight->status = response->status;
+        flight->curl_code = response->curl_code;
+
+        if (response->json) {
+            flight->json = response->json;
+            for (int i = 0; i < flight->waiters; i++) {
+                json_object_get(flight->json);
+            }
+        }
+        if (response->body) {
+            flight->body = malloc(response->body_size + 1);
+            if (flight->body) {
+                memcpy(flight->body, response->body, response->body_size + 1);
+                flight->body_size = response->body_size;
+            } else {
+                flight->ok = false;
+            }
+        }
+    }
+
+    flight->done = true;
+    pthread_cond_broadcast(&flight->cond);
+    pthread_mutex_unlock(&flights_lock);
+
+    // Without waiters nobody else holds the flight any more
+    if (!shared) flight_free(flight);
+}
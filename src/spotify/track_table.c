@@ -0,0 +1,330 @@
+#include "spotify/spotify_internal.h"
+#include "spotify/track_table.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TRACK_URI_PREFIX "spotify:track:"
+
+// Returned by the pool when it cannot grow
+#define STR_REF_FAILED UINT32_MAX
+
+// ===== STRING POOL =====
+
+static uint32_t hash_string(const char *str) {
+    uint32_t hash = 2166136261u;
+    for (const unsigned char *p = (const unsigned char *)str; *p; p++) {
+        hash ^= *p;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static bool pool_init(SpotifyStringPool *pool, size_t capacity) {
+    memset(pool, 0, sizeof(SpotifyStringPool));
+
+    pool->capacity = capacity < 64 ? 64 : capacity;
+    pool->data = malloc(pool->capacity);
+    if (!pool->data) return false;
+
+    // Offset 0 is the shared empty string
+    pool->data[0] = '\0';
+    pool->size = 1;
+    return true;
+}
+
+static void pool_free(SpotifyStringPool *pool) {
+    free(pool->data);
+    free(pool->slots);
+    memset(pool, 0, sizeof(SpotifyStringPool));
+}
+
+static SpotifyStrRef pool_add(SpotifyStringPool *pool, const char *str) {
+    size_t len = strlen(str);
+    if (len == 0) return 0;
+
+    if (pool->size + len + 1 >= STR_REF_FAILED) return STR_REF_FAILED;
+
+    if (pool->size + len + 1 > pool->capacity) {
+        size_t capacity = pool->capacity * 2;
+        while (capacity < pool->size + len + 1) capacity *= 2;
+
+        char *grown = realloc(pool->data, capacity);
+        if (!grown) return STR_REF_FAILED;
+        pool->data = grown;
+        pool->capacity = capacity;
+    }
+
+    SpotifyStrRef ref = (SpotifyStrRef)pool->size;
+    memcpy(pool->data + pool->size, str, len + 1);
+    pool->size += len + 1;
+    return ref;
+}
+
+static bool pool_grow_slots(SpotifyStringPool *pool) {
+    size_t slot_count = pool->slot_count ? pool->slot_count * 2 : 256;
+    SpotifyStrRef *slots = calloc(slot_count, sizeof(SpotifyStrRef));
+    if (!slots) return false;
+
+    for (size_t i = 0; i < pool->slot_count; i++) {
+        SpotifyStrRef ref = pool->slots[i];
+        if (!ref) continue;
+
+        size_t j = hash_string(pool->data + ref) & (slot_count - 1);
+        while (slots[j]) j = (j + 1) & (slot_count - 1);
+        slots[j] = ref;
+    }
+
+    free(pool->slots);
+    pool->slots = slots;
+    pool->slot_count = slot_count;
+    return true;
+}
+
+/**
+ * Store str once; later calls with an equal string return the same reference
+ */
+static SpotifyStrRef pool_intern(SpotifyStringPool *pool, const char *str) {
+    if (!str[0]) return 0;
+
+    // Keep the load factor under 1/2
+    if ((pool->interned + 1) * 2 > pool->slot_count && !pool_grow_slots(pool)) {
+        return pool_add(pool, str);
+    }
+
+    size_t mask = pool->slot_count - 1;
+    size_t i = hash_string(str) & mask;
+    while (pool->slots[i]) {
+        if (strcmp(pool->data + pool->slots[i], str) == 0) return pool->slots[i];
+        i = (i + 1) & mask;
+    }
+
+    SpotifyStrRef ref = pool_add(pool, str);
+    if (ref != STR_REF_FAILED) {
+        pool->slots[i] = ref;
+        pool->interned++;
+    }
+    return ref;
+}
+
+// ===== TABLE =====
+
+static bool table_reserve(SpotifyTrackTable *table, int needed) {
+    if (needed <= table->capacity) return true;
+
+    int capacity = table->capacity ? table->capacity * 2 : 64;
+    while (capacity < needed) capacity *= 2;
+
+    void *ids = realloc(table->ids, sizeof(*table->ids) * capacity);
+    if (!ids) return false;
+    table->ids = ids;
+
+    int32_t *duration_ms = realloc(table->duration_ms, sizeof(int32_t) * capacity);
+    if (!duration_ms) return false;
+    table->duration_ms = duration_ms;
+
+    SpotifyStrRef **columns[] = { &table->names, &table->artists, &table->albums, &table->uris };
+    for (size_t c = 0; c < sizeof(columns) / sizeof(columns[0]); c++) {
+        SpotifyStrRef *grown = realloc(*columns[c], sizeof(SpotifyStrRef) * capacity);
+        if (!grown) return false;
+        *columns[c] = grown;
+    }
+
+    table->capacity = capacity;
+    return true;
+}
+
+SpotifyTrackTable* spotify_track_table_new(int capacity_hint) {
+    SpotifyTrackTable *table = calloc(1, sizeof(SpotifyTrackTable));
+    if (!table) return NULL;
+
+    // Rough guess of 24 bytes of unique strings per track
+    size_t string_hint = capacity_hint > 0 ? (size_t)capacity_hint * 24 : 0;
+    if (!pool_init(&table->strings, string_hint) ||
+        (capacity_hint > 0 && !table_reserve(table, capacity_hint))) {
+        spotify_track_table_free(table);
+        return NULL;
+    }
+
+    return table;
+}
+
+void spotify_track_table_free(SpotifyTrackTable *table) {
+    if (!table) return;
+    free(table->ids);
+    free(table->duration_ms);
+    free(table->names);
+    free(table->artists);
+    free(table->albums);
+    free(table->uris);
+    pool_free(&table->strings);
+    free(table);
+}
+
+bool spotify_track_table_append(SpotifyTrackTable *table, const SpotifyTrack *track) {
+    if (!table || !track) return false;
+    if (!table_reserve(table, table->count + 1)) return false;
+
+    int row = table->count;
+
+    snprintf(table->ids[row], SPOTIFY_TRACK_ID_SIZE, "%s", track->id);
+    table->duration_ms[row] = track->duration_ms;
+    table->names[row] = pool_add(&table->strings, track->name);
+    table->artists[row] = pool_intern(&table->strings, track->artist);
+    table->albums[row] = pool_intern(&table->strings, track->album);
+
+    // Only store URIs that cannot be rebuilt from the ID (local files, episodes)
+    table->uris[row] = 0;
+    if (track->uri[0]) {
+        size_t prefix_len = strlen(TRACK_URI_PREFIX);
+        bool derivable = strncmp(track->uri, TRACK_URI_PREFIX, prefix_len) == 0 &&
+                         strcmp(track->uri + prefix_len, table->ids[row]) == 0;
+        if (!derivable) {
+            table->uris[row] = pool_add(&table->strings, track->uri);
+        }
+    }
+
+    if (table->names[row] == STR_REF_FAILED || table->artists[row] == STR_REF_FAILED ||
+        table->albums[row] == STR_REF_FAILED || table->uris[row] == STR_REF_FAILED) {
+        return false;
+    }
+
+    table->count++;
+    return true;
+}
+
+SpotifyTrackTable* spotify_track_table_from_list(const SpotifyTrackList *list) {
+    if (!list) return NULL;
+
+    SpotifyTrackTable *table = spotify_track_table_new(list->count);
+    if (!table) return NULL;
+
+    for (int i = 0; i < list->count; i++) {
+        if (!spotify_track_table_append(table, &list->tracks[i])) {
+            spotify_track_table_free(table);
+            return NULL;
+        }
+    }
+
+    return table;
+}
+
+void spotify_track_table_get(const SpotifyTrackTable *table, int index, SpotifyTrack *track) {
+    memset(track, 0, sizeof(SpotifyTrack));
+    if (!table || index < 0 || index >= table->count) return;
+
+    const char *data = table->strings.data;
+
+    snprintf(track->id, sizeof(track->id), "%s", table->ids[index]);
+    snprintf(track->name, sizeof(track->name), "%s", data + table->names[index]);
+    snprintf(track->artist, sizeof(track->artist), "%s", data + table->artists[index]);
+    snprintf(track->album, sizeof(track->album), "%s", data + table->albums[index]);
+    track->duration_ms = table->duration_ms[index];
+
+    if (table->uris[index]) {
+        snprintf(track->uri, sizeof(track->uri), "%s", data + table->uris[index]);
+    } else if (track->id[0]) {
+        snprintf(track->uri, sizeof(track->uri), TRACK_URI_PREFIX "%s", track->id);
+    }
+}
+
+SpotifyTrackList* spotify_track_table_to_list(const SpotifyTrackTable *table) {
+    if (!table) return NULL;
+
+    SpotifyTrackList *list = malloc(sizeof(SpotifyTrackList));
+    if (!list) return NULL;
+
+    list->tracks = malloc(sizeof(SpotifyTrack) * (table->count > 0 ? table->count : 1));
+    if (!list->tracks) {
+        free(list);
+        return NULL;
+    }
+
+    for (int i = 0; i < table->count; i++) {
+        spotify_track_table_get(table, i, &list->tracks[i]);
+    }
+
+    list->count = table->count;
+    list->total = table->count;
+    return list;
+}
+
+const char* spotify_track_table_name(const SpotifyTrackTable *table, int index) {
+    return table->strings.data + table->names[index];
+}
+
+const char* spotify_track_table_artist(const SpotifyTrackTable *table, int index) {
+    return table->strings.data + table->artists[index];
+}
+
+const char* spotify_track_table_album(const SpotifyTrackTable *table, int index) {
+    return table->strings.data + table->albums[index];
+}
+
+size_t spotify_track_table_memory(const SpotifyTrackTable *table) {
+    if (!table) return 0;
+
+    size_t row = sizeof(*table->ids) + sizeof(int32_t) + 4 * sizeof(SpotifyStrRef);
+    return sizeof(SpotifyTrackTable) +
+           row * (size_t)table->capacity +
+           table->strings.capacity +
+           table->strings.slot_count * sizeof(SpotifyStrRef);
+}
+
+// ===== LIBRARY =====
+
+// Move a batch of legacy tracks into the table
+static bool table_append_tracks(SpotifyTrackTable *table, const SpotifyTrack *tracks, int count) {
+    for (int i = 0; i < count; i++) {
+        if (!spotify_track_table_append(table, &tracks[i])) return false;
+    }
+    return true;
+}
+
+SpotifyTrackTable* spotify_get_all_saved_tracks_table(SpotifyToken *token) {
+    SpotifyTrackList *first = spotify_get_saved_tracks(token, SPOTIFY_MAX_LIMIT_TRACKS, 0);
+    if (!first) return NULL;
+
+    SpotifyTrackTable *table = spotify_track_table_new(first->total);
+    if (!table || !table_append_tracks(table, first->tracks, first->count)) {
+        spotify_track_table_free(table);
+        spotify_free_track_list(first);
+        return NULL;
+    }
+
+    int fetched = first->count;
+    int total = first->total;
+    spotify_free_track_list(first);
+
+    if (fetched >= total) return table;
+
+    int page_count = 0;
+    SpotifyResponse *pages = spotify_fetch_pages(token, ENDPOINT_USER_TRACKS,
+                                                 SPOTIFY_MAX_LIMIT_TRACKS, fetched, total,
+                                                 SPOTIFY_LISTING_SINK, &page_count);
+    if (!pages) {
+        spotify_track_table_free(table);
+        return NULL;
+    }
+
+    // Expand one page at a time so only a page worth of legacy structs is alive
+    bool ok = true;
+    for (int p = 0; p < page_count && ok; p++) {
+        SpotifyTrack *tracks = NULL;
+        int count = 0;
+
+        ok = spotify_append_track_pages(&tracks, &count, &pages[p], 1, "track") &&
+             table_append_tracks(table, tracks, count);
+
+        spotify_mem_free(tracks);
+        spotify_response_free(&pages[p]);
+    }
+    spotify_free_pages(pages, page_count);
+
+    if (!ok) {
+        spotify_track_table_free(table);
+        return NULL;
+    }
+
+    return table;
+}
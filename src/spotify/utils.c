@@ -3,106 +3,106 @@
 
 void spotify_free_album_list(SpotifyAlbumList *list) {
     if (!list) return;
-    free(list->albums);
-    free(list);
+    spotify_mem_free(list->albums);
+    spotify_mem_free(list);
 }
 
 
 void spotify_free_artist_list(SpotifyArtistList *list) {
     if (!list) return;
-    free(list->artists);
-    free(list);
+    spotify_mem_free(list->artists);
+    spotify_mem_free(list);
 }
 
 void spotify_free_artist(SpotifyArtist *artist) {
     if (!artist) return;
-    free(artist);
+    spotify_mem_free(artist);
 }
 
 void spotify_free_player_state(SpotifyPlayerState *state) {
     if (!state) return;
-    free(state);
+    spotify_mem_free(state);
 }
 
 
 void spotify_free_playlist_full(SpotifyPlaylistFull *playlist) {
     if (!playlist) return;
     if (playlist->tracks) {
-        free(playlist->tracks);
+        spotify_mem_free(playlist->tracks);
     }
-    free(playlist);
+    spotify_mem_free(playlist);
 }
 
 
 void spotify_free_playlist_list(SpotifyPlaylistList *list) {
     if (!list) return;
-    free(list->playlists);
-    free(list);
+    spotify_mem_free(list->playlists);
+    spotify_mem_free(list);
 }
 
 
 void spotify_free_playlist_result(SpotifyPlaylistResult *result) {
     if (!result) return;
-    free(result);
+    spotify_mem_free(result);
 }
 
 
 void spotify_free_queue(SpotifyQueue *queue) {
     if (!queue) return;
     if (queue->queue) {
-        free(queue->queue);
+        spotify_mem_free(queue->queue);
     }
-    free(queue);
+    spotify_mem_free(queue);
 }
 
 void spotify_free_track(SpotifyTrack *track) {
     if (!track) return;
-    free(track);
+    spotify_mem_free(track);
 }
 
 void spotify_free_track_list(SpotifyTrackList *list) {
     if (!list) return;
-    free(list->tracks);
-    free(list);
+    spotify_mem_free(list->tracks);
+    spotify_mem_free(list);
 }
 
 void spotify_free_album_detailed(SpotifyAlbumDetailed *album) {
     if (!album) return;
     if (album->tracks) {
-        free(album->tracks);
+        spotify_mem_free(album->tracks);
     }
-    free(album);
+    spotify_mem_free(album);
 }
 
 void spotify_free_user_profile(SpotifyUserProfile *profile) {
     if (!profile) return;
-    free(profile);
+    spotify_mem_free(profile);
 }
 
 void spotify_free_audio_features(SpotifyAudioFeatures *features) {
     if (!features) return;
-    free(features);
+    spotify_mem_free(features);
 }
 
 void spotify_free_audio_features_batch(SpotifyAudioFeatures *features, int count) {
     if (!features) return;
-    free(features);
+    spotify_mem_free(features);
 }
 
 void spotify_free_recommendations(SpotifyRecommendations *recommendations) {
     if (!recommendations) return;
     if (recommendations->tracks) {
-        free(recommendations->tracks);
+        spotify_mem_free(recommendations->tracks);
     }
-    free(recommendations);
+    spotify_mem_free(recommendations);
 }
 
 void spotify_free_recently_played(SpotifyRecentlyPlayed *history) {
     if (!history) return;
     if (history->history) {
-        free(history->history);
+        spotify_mem_free(history->history);
     }
-    free(history);
+    spotify_mem_free(history);
 }
 
 void spotify_print_album(SpotifyAlbum *album, int index) {
@@ -0,0 +1,161 @@
+#include "watch.h"
+#include "api.h"
+#include <json-c/json.h>
+#include <stdio.h>
+#include <string.h>
+#include <signal.h>
+#include <time.h>
+
+/**
+ * Watch mode: poll the player and print what changed as newline-delimited
+ * JSON, one event per line:
+ *
+ *   {"event":"track_changed","at":...,"track_id":...,"is_playing":...,...}
+ *   {"event":"paused",...} / {"event":"resumed",...}
+ *   {"event":"device_changed","device_id":...,"volume_percent":...,...}
+ *   {"event":"volume_changed","volume_percent":...}
+ *   {"event":"stopped"}         no device is active any more
+ *
+ * The first poll is compared with an empty player, so it describes the
+ * whole current state. The poll rate follows what can change: the next
+ * poll of a playing track is due at its predicted end, paused and idle
+ * players are polled slowly, and failed polls back off exponentially.
+ */
+
+static volatile sig_atomic_t stop_requested = 0;
+
+static void handle_stop(int sig) {
+    (void)sig;
+    stop_requested = 1;
+}
+
+static long long now_ms(clockid_t clock) {
+    struct timespec ts;
+    clock_gettime(clock, &ts);
+    return (long long)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+// Returns early when a signal asks to stop
+static void sleep_ms(long ms) {
+    struct timespec ts = { .tv_sec = ms / 1000, .tv_nsec = (ms % 1000) * 1000000L };
+    nanosleep(&ts, NULL);
+}
+
+// ===== EVENTS =====
+
+static struct json_object* new_event(const char *name) {
+    struct json_object *event = json_object_new_object();
+    json_object_object_add(event, "event", json_object_new_string(name));
+    json_object_object_add(event, "at", json_object_new_int64(now_ms(CLOCK_REALTIME)));
+    return event;
+}
+
+// Print one event line; false once stdout is gone
+static bool emit(struct json_object *event) {
+    printf("%s\n", json_object_to_json_string_ext(event, JSON_C_TO_STRING_PLAIN));
+    json_object_put(event);
+    return fflush(stdout) == 0 && !ferror(stdout);
+}
+
+static void add_track(struct json_object *event, const SpotifyPlayerState *state) {
+    json_object_object_add(event, "track_id", json_object_new_string(state->track_id));
+    json_object_object_add(event, "progress_ms", json_object_new_int(state->progress_ms));
+}
+
+/**
+ * Print the events that lead from previous to current
+ * An inactive player is an empty state
+ */
+static bool emit_changes(const SpotifyPlayerState *previous, bool was_active,
+                         const SpotifyPlayerState *current, bool active) {
+    if (!active) {
+        return !was_active || emit(new_event("stopped"));
+    }
+
+    if (strcmp(previous->track_id, current->track_id) != 0) {
+        struct json_object *event = new_event("track_changed");
+        add_track(event, current);
+        json_object_object_add(event, "track_uri", json_object_new_string(current->track_uri));
+        json_object_object_add(event, "track_name", json_object_new_string(current->track_name));
+        json_object_object_add(event, "artist", json_object_new_string(current->artist_name));
+        json_object_object_add(event, "album", json_object_new_string(current->album_name));
+        json_object_object_add(event, "duration_ms", json_object_new_int(current->duration_ms));
+        json_object_object_add(event, "is_playing", json_object_new_boolean(current->is_playing));
+        if (!emit(event)) return false;
+    }
+
+    if (previous->is_playing != current->is_playing) {
+        struct json_object *event = new_event(current->is_playing ? "resumed" : "paused");
+        add_track(event, current);
+        if (!emit(event)) return false;
+    }
+
+    if (strcmp(previous->device.device_id, current->device.device_id) != 0) {
+        struct json_object *event = new_event("device_changed");
+        json_object_object_add(event, "device_id", json_object_new_string(current->device.device_id));
+        json_object_object_add(event, "device_name", json_object_new_string(current->device.device_name));
+        json_object_object_add(event, "device_type", json_object_new_string(current->device.device_type));
+        json_object_object_add(event, "volume_percent", json_object_new_int(current->device.volume_percent));
+        if (!emit(event)) return false;
+    } else if (previous->device.volume_percent != current->device.volume_percent) {
+        struct json_object *event = new_event("volume_changed");
+        json_object_object_add(event, "volume_percent", json_object_new_int(current->device.volume_percent));
+        if (!emit(event)) return false;
+    }
+
+    return true;
+}
+
+// ===== SCHEDULER =====
+
+// Delay until the next poll after a successful one
+static long next_poll_ms(const SpotifyPlayerState *state, bool active) {
+    if (!active) return WATCH_IDLE_INTERVAL_MS;
+    if (!state->is_playing) return WATCH_PAUSED_INTERVAL_MS;
+
+    long delay = WATCH_PLAYING_INTERVAL_MS;
+    if (state->duration_ms > 0) {
+        long until_end = (long)state->duration_ms - state->progress_ms + WATCH_TRACK_END_SLACK_MS;
+        if (until_end < delay) delay = until_end;
+    }
+    return delay < WATCH_MIN_INTERVAL_MS ? WATCH_MIN_INTERVAL_MS : delay;
+}
+
+int watch_player(SpotifyToken *token) {
+    // No SA_RESTART: a signal cuts the sleep between polls short
+    struct sigaction stop = {0};
+    stop.sa_handler = handle_stop;
+    sigemptyset(&stop.sa_mask);
+    sigaction(SIGINT, &stop, NULL);
+    sigaction(SIGTERM, &stop, NULL);
+    signal(SIGPIPE, SIG_IGN);
+
+    SpotifyPlayerState previous = {0};
+    bool was_active = false;
+    long backoff = 0;
+
+    while (!stop_requested) {
+        SpotifyPlayerState current = {0};
+        bool active = false;
+        long long polled_at = now_ms(CLOCK_MONOTONIC);
+
+        long delay;
+        if (spotify_fetch_player_state(token, &current, &active)) {
+            if (!emit_changes(&previous, was_active, &current, active)) break;
+            previous = current;
+            was_active = active;
+            backoff = 0;
+            delay = next_poll_ms(&current, active);
+        } else {
+            backoff = backoff ? backoff * 2 : WATCH_ERROR_BACKOFF_MS;
+            if (backoff > WATCH_ERROR_BACKOFF_CAP_MS) backoff = WATCH_ERROR_BACKOFF_CAP_MS;
+            delay = backoff;
+        }
+
+        // The delay counts from when the poll was sent
+        delay -= (long)(now_ms(CLOCK_MONOTONIC) - polled_at);
+        if (delay > 0 && !stop_requested) sleep_ms(delay);
+    }
+
+    return 0;
+}
@@ -0,0 +1,110 @@
+#include "spotify/spotify_internal.h"
+#include "mock_server.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/**
+ * Convergence of the adaptive concurrency window (limiter.c)
+ *
+ * A batch runs against the stand-in server (mock_server.c) limited to a
+ * fixed number of requests at once, each taking a while to process, so
+ * going over that capacity costs 503s. The window is sampled as requests
+ * complete: it should grow past the capacity, get cut back and settle
+ * around it instead of staying at the initial value or the maximum.
+ *
+ * Usage: aimd_test [capacity] [requests]
+ */
+
+#define AIMD_LATENCY_MS 400
+#define AIMD_TRACE_POINTS 20
+
+typedef struct {
+    SpotifyLimiter *limiter;
+    int *windows;
+    int completed;
+} Trace;
+
+static void on_done(int index, bool ok, SpotifyResponse *response, void *userdata) {
+    (void)index;
+    (void)ok;
+    (void)response;
+
+    Trace *trace = userdata;
+    trace->windows[trace->completed++] = spotify_limiter_window(trace->limiter);
+}
+
+int main(int argc, char *argv[]) {
+    int capacity = argc > 1 ? atoi(argv[1]) : 6;
+    int count = argc > 2 ? atoi(argv[2]) : 300;
+    if (capacity < 1) capacity = 1;
+    if (count < AIMD_TRACE_POINTS) count = AIMD_TRACE_POINTS;
+
+    setenv("SPOTCLI_NO_CACHE", "1", 1);
+
+    MockServerConfig config = { .capacity = capacity, .latency_ms = AIMD_LATENCY_MS };
+    MockServer *server = mock_server_start(&config);
+    if (!server) return 1;
+
+    SpotifyToken token;
+    memset(&token, 0, sizeof(token));
+    snprintf(token.access_token, sizeof(token.access_token), "test");
+    token.expires_in = 3600;
+    token.obtained_at = time(NULL);
+
+    SpotifyRequest *requests = calloc(count, sizeof(SpotifyRequest));
+    SpotifyResponse *responses = calloc(count, sizeof(SpotifyResponse));
+    char (*urls)[128] = calloc(count, sizeof(*urls));
+    Trace trace = { .limiter = spotify_token_client(&token)->limiter, .windows = calloc(count, sizeof(int)) };
+    if (!requests || !responses || !urls || !trace.windows) return 1;
+
+    for (int i = 0; i < count; i++) {
+        snprintf(urls[i], sizeof(urls[i]), "http://127.0.0.1:%d/v1/albums/%022d",
+                 mock_server_port(server), i);
+        requests[i].method = SPOTIFY_METHOD_GET;
+        requests[i].url = urls[i];
+        requests[i].sink = SPOTIFY_SINK_JSON;
+        requests[i].bypass_cache = true;
+    }
+
+    long long started = spotify_monotonic_ms();
+    int succeeded = spotify_request_batch(&token, requests, count, responses, NULL, on_done, &trace);
+    long long elapsed_ms = spotify_monotonic_ms() - started;
+
+    for (int i = 0; i < count; i++) {
+        spotify_response_free(&responses[i]);
+    }
+
+    MockServerStats stats;
+    mock_server_stats(server, &stats);
+    mock_server_stop(server);
+
+    printf("window:");
+    for (int p = 0; p < AIMD_TRACE_POINTS; p++) {
+        printf(" %d", trace.windows[(long)p * (trace.completed - 1) / (AIMD_TRACE_POINTS - 1)]);
+    }
+    printf("\n");
+
+    // Settled part of the run: the second half
+    double mean = 0;
+    int settled = trace.completed - trace.completed / 2;
+    for (int i = trace.completed / 2; i < trace.completed; i++) {
+        mean += trace.windows[i];
+    }
+    mean = settled > 0 ? mean / settled : 0;
+
+    printf("aimd: capacity %d, mean window %.1f over the second half (max %d)\n",
+           capacity, mean, SPOTIFY_BATCH_MAX_PARALLEL);
+    printf("batch: %d/%d ok in %lld ms; server: %ld served, %ld shed, peak %d at once\n",
+           succeeded, count, elapsed_ms, stats.served, stats.shed, stats.peak);
+
+    bool converged = mean >= capacity * 0.5 && mean <= capacity * 2.0;
+    if (!converged) printf("FAIL: window did not settle around the capacity\n");
+
+    free(requests);
+    free(responses);
+    free(urls);
+    free(trace.windows);
+    return converged ? 0 : 1;
+}
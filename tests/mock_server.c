@@ -0,0 +1,304 @@
+#include "mock_server.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+#include <poll.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+struct MockServer {
+    MockServerConfig config;
+    int listen_fd;
+    int port;
+    pthread_t thread;
+    bool stopping;
+
+    // Token bucket and the pause announced by the last 429
+    double tokens;
+    long long refilled_at;
+    long long paused_until;
+
+    int processing;             // Accepted requests not answered yet
+    MockServerStats stats;
+    int connections;            // Connection threads still running
+    pthread_mutex_t lock;
+    pthread_cond_t idle;
+};
+
+typedef struct {
+    MockServer *server;
+    int fd;
+} Connection;
+
+static long long now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+// ===== ADMISSION =====
+
+/**
+ * Decide how to answer a request that just arrived
+ * Returns the HTTP status; called with the lock held
+ */
+static int admit(MockServer *server) {
+    long long now = now_ms();
+    server->stats.requests++;
+
+    if (server->config.capacity > 0 && server->processing >= server->config.capacity) {
+        server->stats.shed++;
+        return 503;
+    }
+
+    if (server->config.rate <= 0) {
+        server->stats.served++;
+        return 200;
+    }
+
+    if (now < server->paused_until) {
+        server->stats.early++;
+        server->stats.throttled++;
+        return 429;
+    }
+
+    server->tokens += (now - server->refilled_at) / 1000.0 * server->config.rate;
+    if (server->tokens > server->config.burst) server->tokens = server->config.burst;
+    server->refilled_at = now;
+
+    if (server->tokens < 1.0) {
+        server->paused_until = now + server->config.retry_after * 1000;
+        server->stats.throttled++;
+        return 429;
+    }
+
+    server->tokens -= 1.0;
+    server->stats.served++;
+    return 200;
+}
+
+// ===== CONNECTIONS =====
+
+static bool stopping(MockServer *server) {
+    pthread_mutex_lock(&server->lock);
+    bool stopping = server->stopping;
+    pthread_mutex_unlock(&server->lock);
+    return stopping;
+}
+
+/**
+ * Read the headers of the next request on a kept-alive connection
+ * Returns false when the client closes it or the server is stopping
+ */
+static bool read_request(MockServer *server, int fd) {
+    char buffer[8192];
+    size_t used = 0;
+
+    while (used < sizeof(buffer) - 1) {
+        struct pollfd pfd = { .fd = fd, .events = POLLIN };
+        if (poll(&pfd, 1, 100) == 0) {
+            if (stopping(server)) return false;
+            continue;
+        }
+
+        ssize_t n = recv(fd, buffer + used, sizeof(buffer) - 1 - used, 0);
+        if (n <= 0) return false;
+        used += n;
+        buffer[used] = '\0';
+        if (strstr(buffer, "\r\n\r\n")) return true;
+    }
+    return false;
+}
+
+static void write_all(int fd, const char *data, size_t size) {
+    while (size > 0) {
+        ssize_t n = send(fd, data, size, MSG_NOSIGNAL);
+        if (n <= 0) return;
+        data += n;
+        size -= n;
+    }
+}
+
+static void* connection_thread(void *arg) {
+    Connection *connection = arg;
+    MockServer *server = connection->server;
+
+    while (read_request(server, connection->fd)) {
+        pthread_mutex_lock(&server->lock);
+        int status = admit(server);
+        if (status == 200) {
+            server->processing++;
+            if (server->processing > server->stats.peak) server->stats.peak = server->processing;
+        }
+        pthread_mutex_unlock(&server->lock);
+
+        if (status == 200 && server->config.latency_ms > 0) {
+            struct timespec delay = {
+                .tv_sec = server->config.latency_ms / 1000,
+                .tv_nsec = (server->config.latency_ms % 1000) * 1000000L
+            };
+            nanosleep(&delay, NULL);
+        }
+
+        char response[512];
+        int length;
+        if (status == 503) {
+            length = snprintf(response, sizeof(response),
+                              "HTTP/1.1 503 Service Unavailable\r\n"
+                              "Content-Length: 0\r\n\r\n");
+        } else if (status == 429) {
+            const char *body = "{\"error\":{\"status\":429,\"message\":\"API rate limit exceeded\"}}";
+            length = snprintf(response, sizeof(response),
+                              "HTTP/1.1 429 Too Many Requests\r\n"
+                              "Content-Type: application/json\r\n"
+                              "Retry-After: %ld\r\n"
+                              "Content-Length: %zu\r\n\r\n%s",
+                              server->config.retry_after, strlen(body), body);
+        } else {
+            const char *body = "{\"items\":[],\"total\":0}";
+            length = snprintf(response, sizeof(response),
+                              "HTTP/1.1 200 OK\r\n"
+                              "Content-Type: application/json\r\n"
+                              "Content-Length: %zu\r\n\r\n%s",
+                              strlen(body), body);
+        }
+        write_all(connection->fd, response, length);
+
+        if (status == 200) {
+            pthread_mutex_lock(&server->lock);
+            server->processing--;
+            pthread_mutex_unlock(&server->lock);
+        }
+    }
+
+    close(connection->fd);
+    free(connection);
+
+    pthread_mutex_lock(&server->lock);
+    server->connections--;
+    pthread_cond_signal(&server->idle);
+    pthread_mutex_unlock(&server->lock);
+    return NULL;
+}
+
+static void* accept_thread(void *arg) {
+    MockServer *server = arg;
+
+    while (!stopping(server)) {
+        struct pollfd pfd = { .fd = server->listen_fd, .events = POLLIN };
+        if (poll(&pfd, 1, 100) <= 0) continue;
+
+        int fd = accept(server->listen_fd, NULL, NULL);
+        if (fd < 0) continue;
+
+        Connection *connection = malloc(sizeof(Connection));
+        if (!connection) {
+            close(fd);
+            continue;
+        }
+        connection->server = server;
+        connection->fd = fd;
+
+        pthread_mutex_lock(&server->lock);
+        server->connections++;
+        pthread_mutex_unlock(&server->lock);
+
+        pthread_t thread;
+        if (pthread_create(&thread, NULL, connection_thread, connection) != 0) {
+            close(fd);
+            free(connection);
+            pthread_mutex_lock(&server->lock);
+            server->connections--;
+            pthread_mutex_unlock(&server->lock);
+            continue;
+        }
+        pthread_detach(thread);
+    }
+    return NULL;
+}
+
+// ===== LIFECYCLE =====
+
+MockServer* mock_server_start(const MockServerConfig *config) {
+    MockServer *server = calloc(1, sizeof(MockServer));
+    if (!server) return NULL;
+
+    server->config = *config;
+    if (server->config.burst < 1) server->config.burst = 1;
+    if (server->config.retry_after < 1) server->config.retry_after = 1;
+    server->tokens = server->config.burst;
+    server->refilled_at = now_ms();
+    pthread_mutex_init(&server->lock, NULL);
+    pthread_cond_init(&server->idle, NULL);
+
+    server->listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (server->listen_fd < 0) {
+        perror("socket");
+        free(server);
+        return NULL;
+    }
+
+    int yes = 1;
+    setsockopt(server->listen_fd, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = 0;
+
+    socklen_t len = sizeof(addr);
+    if (bind(server->listen_fd, (struct sockaddr *)&addr, sizeof(addr)) < 0 ||
+        listen(server->listen_fd, 128) < 0 ||
+        getsockname(server->listen_fd, (struct sockaddr *)&addr, &len) < 0) {
+        perror("mock server");
+        close(server->listen_fd);
+        free(server);
+        return NULL;
+    }
+    server->port = ntohs(addr.sin_port);
+
+    if (pthread_create(&server->thread, NULL, accept_thread, server) != 0) {
+        close(server->listen_fd);
+        free(server);
+        return NULL;
+    }
+    return server;
+}
+
+int mock_server_port(const MockServer *server) {
+    return server->port;
+}
+
+void mock_server_stats(MockServer *server, MockServerStats *stats) {
+    pthread_mutex_lock(&server->lock);
+    *stats = server->stats;
+    pthread_mutex_unlock(&server->lock);
+}
+
+/**
+ * Stop accepting, wait for the open connections to finish and free the server
+ */
+void mock_server_stop(MockServer *server) {
+    if (!server) return;
+
+    pthread_mutex_lock(&server->lock);
+    server->stopping = true;
+    pthread_mutex_unlock(&server->lock);
+    pthread_join(server->thread, NULL);
+    close(server->listen_fd);
+
+    pthread_mutex_lock(&server->lock);
+    while (server->connections > 0) {
+        pthread_cond_wait(&server->idle, &server->lock);
+    }
+    pthread_mutex_unlock(&server->lock);
+
+    pthread_cond_destroy(&server->idle);
+    pthread_mutex_destroy(&server->lock);
+    free(server);
+}
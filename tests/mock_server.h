@@ -0,0 +1,45 @@
+#ifndef MOCK_SERVER_H
+#define MOCK_SERVER_H
+
+#include <stdbool.h>
+
+/**
+ * Stand-in for the Web API on 127.0.0.1, for tests that exercise the
+ * request engine without the network
+ *
+ * Every request is answered with a small JSON page. The server keeps its
+ * own token bucket: once it is empty a request gets a 429 with
+ * Retry-After, and everything arriving before that pause is over gets
+ * another 429 (counted as early, since a well-behaved client holds back).
+ * With a capacity, a request that arrives while that many are being
+ * processed is shed with a 503, like an overloaded backend.
+ */
+typedef struct {
+    double rate;            // Requests per second the server accepts, 0 for no limit
+    int burst;              // Bucket size
+    long retry_after;       // Seconds sent in Retry-After
+    int capacity;           // Requests processed at once, 0 for no limit
+    long latency_ms;        // Processing time of an accepted request
+} MockServerConfig;
+
+typedef struct {
+    long requests;
+    long served;
+    long throttled;         // 429 answers
+    long early;             // Requests that arrived during a pause the server announced
+    long shed;              // 503 answers over capacity
+    int peak;               // Most requests processed at once
+} MockServerStats;
+
+typedef struct MockServer MockServer;
+
+/**
+ * Listen on an ephemeral port and serve until mock_server_stop()
+ * Returns NULL if the socket cannot be set up
+ */
+MockServer* mock_server_start(const MockServerConfig *config);
+int mock_server_port(const MockServer *server);
+void mock_server_stats(MockServer *server, MockServerStats *stats);
+void mock_server_stop(MockServer *server);
+
+#endif // MOCK_SERVER_H
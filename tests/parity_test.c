@@ -0,0 +1,253 @@
+#include "spotify/spotify_internal.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * Parity test for the zero-DOM parser (fastparse.c)
+ *
+ * Each fixture under tests/fixtures is a recorded API body. It is parsed
+ * once through json-c and the parse_*_json() functions, the way the
+ * default build reads it, and once through fast_parse_*(), the way a
+ * FASTPARSE=1 build reads it; every mapped field must come out the same.
+ *
+ * Usage: parity_test <fixtures directory>
+ */
+
+static int failures = 0;
+static int checks = 0;
+
+#define EXPECT_STR(what, index, json, fast, field) \
+    check_str(what, index, #field, (json)->field, (fast)->field)
+#define EXPECT_INT(what, index, json, fast, field) \
+    check_int(what, index, #field, (long long)(json)->field, (long long)(fast)->field)
+
+static void check_str(const char *what, int index, const char *field, const char *json, const char *fast) {
+    checks++;
+    if (strcmp(json, fast) == 0) return;
+
+    failures++;
+    fprintf(stderr, "FAIL %s[%d].%s\n  json-c: \"%s\"\n  fast:   \"%s\"\n", what, index, field, json, fast);
+}
+
+static void check_int(const char *what, int index, const char *field, long long json, long long fast) {
+    checks++;
+    if (json == fast) return;
+
+    failures++;
+    fprintf(stderr, "FAIL %s[%d].%s\n  json-c: %lld\n  fast:   %lld\n", what, index, field, json, fast);
+}
+
+// ===== FIXTURES =====
+
+typedef struct {
+    char *body;
+    size_t size;
+    struct json_object *root;
+} Fixture;
+
+static bool fixture_load(const char *dir, const char *name, Fixture *fixture) {
+    char path[1024];
+    snprintf(path, sizeof(path), "%s/%s", dir, name);
+
+    memset(fixture, 0, sizeof(*fixture));
+    FILE *f = fopen(path, "rb");
+    if (!f) {
+        fprintf(stderr, "Cannot open fixture %s\n", path);
+        return false;
+    }
+
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+
+    fixture->body = malloc(size > 0 ? size + 1 : 1);
+    fixture->size = fixture->body ? fread(fixture->body, 1, size, f) : 0;
+    fclose(f);
+    if (!fixture->body) return false;
+    fixture->body[fixture->size] = '\0';
+
+    fixture->root = json_tokener_parse(fixture->body);
+    if (!fixture->root) {
+        fprintf(stderr, "Fixture %s is not valid JSON\n", path);
+        free(fixture->body);
+        return false;
+    }
+    return true;
+}
+
+static void fixture_free(Fixture *fixture) {
+    json_object_put(fixture->root);
+    free(fixture->body);
+}
+
+// Array under a top-level key, as both parsers look it up
+static struct json_object* fixture_array(Fixture *fixture, const char *key) {
+    struct json_object *array = NULL;
+    json_object_object_get_ex(fixture->root, key, &array);
+    return array;
+}
+
+// ===== CASES =====
+
+static void compare_tracks(const char *what, int index, const SpotifyTrack *json, const SpotifyTrack *fast) {
+    EXPECT_STR(what, index, json, fast, id);
+    EXPECT_STR(what, index, json, fast, name);
+    EXPECT_STR(what, index, json, fast, artist);
+    EXPECT_STR(what, index, json, fast, album);
+    EXPECT_STR(what, index, json, fast, uri);
+    EXPECT_INT(what, index, json, fast, duration_ms);
+}
+
+/**
+ * Track listing; wrapper is the key holding the track in each item, as in
+ * spotify_append_track_pages()
+ */
+static void test_tracks(const char *dir, const char *name, const char *wrapper) {
+    Fixture fixture;
+    if (!fixture_load(dir, name, &fixture)) {
+        failures++;
+        return;
+    }
+
+    struct json_object *items = fixture_array(&fixture, "items");
+    int expected = items ? (int)json_object_array_length(items) : 0;
+
+    SpotifyTrack *fast = NULL;
+    int count = 0;
+    int parsed = fast_parse_track_items(fixture.body, fixture.size, wrapper, &fast, &count);
+    check_int(name, -1, "count", expected, parsed);
+
+    for (int i = 0; i < expected && i < count; i++) {
+        struct json_object *track = json_object_array_get_idx(items, i);
+        if (wrapper && !json_object_object_get_ex(track, wrapper, &track)) track = NULL;
+
+        SpotifyTrack json;
+        if (track && json_object_get_type(track) != json_type_null) {
+            parse_track_json(track, &json);
+        } else {
+            memset(&json, 0, sizeof(json));
+        }
+        compare_tracks(name, i, &json, &fast[i]);
+    }
+
+    spotify_mem_free(fast);
+    fixture_free(&fixture);
+}
+
+static void test_artists(const char *dir, const char *name) {
+    Fixture fixture;
+    if (!fixture_load(dir, name, &fixture)) {
+        failures++;
+        return;
+    }
+
+    struct json_object *items = fixture_array(&fixture, "artists");
+    int expected = items ? (int)json_object_array_length(items) : 0;
+
+    SpotifyArtist *fast = NULL;
+    int count = 0;
+    int parsed = fast_parse_artist_items(fixture.body, fixture.size, "artists", &fast, &count);
+    check_int(name, -1, "count", expected, parsed);
+
+    for (int i = 0; i < expected && i < count; i++) {
+        struct json_object *item = json_object_array_get_idx(items, i);
+
+        SpotifyArtist json;
+        if (item) {
+            parse_artist_json(item, &json);
+        } else {
+            memset(&json, 0, sizeof(json));
+        }
+
+        EXPECT_STR(name, i, &json, &fast[i], id);
+        EXPECT_STR(name, i, &json, &fast[i], name);
+        EXPECT_STR(name, i, &json, &fast[i], genres);
+        EXPECT_STR(name, i, &json, &fast[i], uri);
+        EXPECT_STR(name, i, &json, &fast[i], image_url);
+        EXPECT_INT(name, i, &json, &fast[i], followers);
+        EXPECT_INT(name, i, &json, &fast[i], popularity);
+    }
+
+    spotify_mem_free(fast);
+    fixture_free(&fixture);
+}
+
+static void test_playlists(const char *dir, const char *name) {
+    Fixture fixture;
+    if (!fixture_load(dir, name, &fixture)) {
+        failures++;
+        return;
+    }
+
+    struct json_object *items = fixture_array(&fixture, "items");
+    int expected = items ? (int)json_object_array_length(items) : 0;
+
+    SpotifyPlaylist *fast = NULL;
+    int count = 0;
+    int parsed = fast_parse_playlist_items(fixture.body, fixture.size, &fast, &count);
+    check_int(name, -1, "count", expected, parsed);
+
+    for (int i = 0; i < expected && i < count; i++) {
+        SpotifyPlaylist json;
+        parse_playlist_json(json_object_array_get_idx(items, i), &json);
+
+        EXPECT_STR(name, i, &json, &fast[i], id);
+        EXPECT_STR(name, i, &json, &fast[i], name);
+        EXPECT_STR(name, i, &json, &fast[i], uri);
+        EXPECT_INT(name, i, &json, &fast[i], is_public);
+        EXPECT_INT(name, i, &json, &fast[i], count_tracks);
+    }
+
+    spotify_mem_free(fast);
+    fixture_free(&fixture);
+}
+
+static void test_player_state(const char *dir, const char *name) {
+    Fixture fixture;
+    if (!fixture_load(dir, name, &fixture)) {
+        failures++;
+        return;
+    }
+
+    SpotifyPlayerState json, fast;
+    parse_player_state_json(fixture.root, &json);
+    check_int(name, 0, "parsed", 1, fast_parse_player_state(fixture.body, fixture.size, &fast));
+
+    EXPECT_STR(name, 0, &json, &fast, track_id);
+    EXPECT_STR(name, 0, &json, &fast, track_name);
+    EXPECT_STR(name, 0, &json, &fast, artist_name);
+    EXPECT_STR(name, 0, &json, &fast, album_name);
+    EXPECT_STR(name, 0, &json, &fast, track_uri);
+    EXPECT_INT(name, 0, &json, &fast, duration_ms);
+    EXPECT_INT(name, 0, &json, &fast, is_playing);
+    EXPECT_INT(name, 0, &json, &fast, progress_ms);
+    EXPECT_INT(name, 0, &json, &fast, timestamp);
+    EXPECT_STR(name, 0, &json, &fast, context_type);
+    EXPECT_STR(name, 0, &json, &fast, context_uri);
+    EXPECT_INT(name, 0, &json, &fast, shuffle_state);
+    EXPECT_STR(name, 0, &json, &fast, repeat_state);
+    EXPECT_STR(name, 0, &json, &fast, device.device_id);
+    EXPECT_STR(name, 0, &json, &fast, device.device_name);
+    EXPECT_STR(name, 0, &json, &fast, device.device_type);
+    EXPECT_INT(name, 0, &json, &fast, device.volume_percent);
+    EXPECT_INT(name, 0, &json, &fast, device.is_active);
+    EXPECT_INT(name, 0, &json, &fast, device.is_private_session);
+    EXPECT_INT(name, 0, &json, &fast, device.is_restricted);
+
+    fixture_free(&fixture);
+}
+
+int main(int argc, char *argv[]) {
+    const char *dir = argc > 1 ? argv[1] : "tests/fixtures";
+
+    test_tracks(dir, "saved_tracks.json", "track");
+    test_tracks(dir, "album_tracks.json", NULL);
+    test_artists(dir, "artists.json");
+    test_playlists(dir, "playlists.json");
+    test_player_state(dir, "player.json");
+    test_player_state(dir, "player_idle.json");
+
+    printf("parity: %d checks, %d failed\n", checks, failures);
+    return failures ? 1 : 0;
+}
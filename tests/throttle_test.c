@@ -0,0 +1,84 @@
+#include "spotify/spotify_internal.h"
+#include "mock_server.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/**
+ * 429 handling against the stand-in server (mock_server.c)
+ *
+ * The server accepts fewer requests per second than the client's own token
+ * bucket allows, so a batch runs into 429s. Every request must still
+ * succeed: the rate limiter holds the class until Retry-After has passed
+ * and the time spent waiting does not count against the default deadline,
+ * even when Retry-After is longer than SPOTIFY_DEFAULT_TIMEOUT_MS.
+ * A few sequential requests follow to cover the blocking path as well.
+ *
+ * Usage: throttle_test [requests] [retry-after seconds]
+ */
+
+#define SEQUENTIAL_REQUESTS 5
+
+int main(int argc, char *argv[]) {
+    int count = argc > 1 ? atoi(argv[1]) : 60;
+    long retry_after = argc > 2 ? atol(argv[2]) : 1;
+    if (count < 1) count = 1;
+
+    setenv("SPOTCLI_NO_CACHE", "1", 1);
+
+    MockServerConfig config = { .rate = 10, .burst = 10, .retry_after = retry_after };
+    MockServer *server = mock_server_start(&config);
+    if (!server) return 1;
+
+    SpotifyToken token;
+    memset(&token, 0, sizeof(token));
+    snprintf(token.access_token, sizeof(token.access_token), "test");
+    token.expires_in = 3600;
+    token.obtained_at = time(NULL);
+
+    SpotifyRequest *requests = calloc(count, sizeof(SpotifyRequest));
+    SpotifyResponse *responses = calloc(count, sizeof(SpotifyResponse));
+    char (*urls)[128] = calloc(count, sizeof(*urls));
+    if (!requests || !responses || !urls) return 1;
+
+    for (int i = 0; i < count; i++) {
+        snprintf(urls[i], sizeof(urls[i]), "http://127.0.0.1:%d/v1/me/tracks?limit=50&offset=%d",
+                 mock_server_port(server), i * 50);
+        requests[i].method = SPOTIFY_METHOD_GET;
+        requests[i].url = urls[i];
+        requests[i].sink = SPOTIFY_SINK_JSON;
+        requests[i].bypass_cache = true;
+    }
+
+    long long started = spotify_monotonic_ms();
+    int succeeded = spotify_request_batch(&token, requests, count, responses, NULL, NULL, NULL);
+    long long batch_ms = spotify_monotonic_ms() - started;
+
+    for (int i = 0; i < count; i++) {
+        spotify_response_free(&responses[i]);
+    }
+
+    int sequential = 0;
+    for (int i = 0; i < SEQUENTIAL_REQUESTS; i++) {
+        SpotifyResponse response;
+        if (spotify_request_perform(&token, &requests[i], &response)) sequential++;
+        spotify_response_free(&response);
+    }
+    long long total_ms = spotify_monotonic_ms() - started;
+
+    MockServerStats stats;
+    mock_server_stats(server, &stats);
+    mock_server_stop(server);
+
+    printf("throttle: batch %d/%d ok in %lld ms, sequential %d/%d ok, %lld ms total\n",
+           succeeded, count, batch_ms, sequential, SEQUENTIAL_REQUESTS, total_ms);
+    printf("server: %ld requests, %ld served, %ld throttled (%ld during a pause), %.1f req/s\n",
+           stats.requests, stats.served, stats.throttled, stats.early,
+           total_ms > 0 ? stats.served * 1000.0 / total_ms : 0.0);
+
+    free(requests);
+    free(responses);
+    free(urls);
+    return succeeded == count && sequential == SEQUENTIAL_REQUESTS ? 0 : 1;
+}
@@ -0,0 +1,107 @@
+#include "spotify/spotify_internal.h"
+#include "spotify/track_table.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * SpotifyTrackTable against the legacy SpotifyTrackList on a synthetic library
+ *
+ * Tracks are spread over a fixed set of artists and albums, the way a real
+ * library repeats them. Reports the memory of both layouts, the time to
+ * build the table, and the time of a full scan (the work of a listing or a
+ * local search) over each.
+ *
+ * Usage: track_table_bench [tracks]
+ */
+
+#define BENCH_ARTISTS 4000
+#define BENCH_ALBUMS_PER_ARTIST 3
+#define BENCH_SCANS 10
+
+static void synthesize(SpotifyTrack *track, int index) {
+    int artist = (int)((index * 2654435761u) % BENCH_ARTISTS);
+    int album = artist * BENCH_ALBUMS_PER_ARTIST + index % BENCH_ALBUMS_PER_ARTIST;
+
+    memset(track, 0, sizeof(*track));
+    snprintf(track->id, sizeof(track->id), "%022d", index);
+    snprintf(track->name, sizeof(track->name), "Track number %d of the library", index);
+    snprintf(track->artist, sizeof(track->artist), "Artist %d", artist);
+    snprintf(track->album, sizeof(track->album), "Album %d by artist %d", album, artist);
+    snprintf(track->uri, sizeof(track->uri), "spotify:track:%s", track->id);
+    track->duration_ms = 120000 + (index * 7919) % 240000;
+}
+
+// Sum of durations and name lengths, so the scan cannot be optimised away
+static long long scan_list(const SpotifyTrackList *list) {
+    long long sum = 0;
+    for (int i = 0; i < list->count; i++) {
+        sum += list->tracks[i].duration_ms + (long long)strlen(list->tracks[i].name) +
+               (long long)strlen(list->tracks[i].artist);
+    }
+    return sum;
+}
+
+static long long scan_table(const SpotifyTrackTable *table) {
+    long long sum = 0;
+    for (int i = 0; i < table->count; i++) {
+        sum += table->duration_ms[i] + (long long)strlen(spotify_track_table_name(table, i)) +
+               (long long)strlen(spotify_track_table_artist(table, i));
+    }
+    return sum;
+}
+
+int main(int argc, char *argv[]) {
+    int count = argc > 1 ? atoi(argv[1]) : 100000;
+    if (count < 1) count = 1;
+
+    SpotifyTrackList list = { .tracks = calloc(count, sizeof(SpotifyTrack)), .count = count, .total = count };
+    if (!list.tracks) return 1;
+    for (int i = 0; i < count; i++) {
+        synthesize(&list.tracks[i], i);
+    }
+
+    long long started = spotify_monotonic_ms();
+    SpotifyTrackTable *table = spotify_track_table_from_list(&list);
+    long long build_ms = spotify_monotonic_ms() - started;
+    if (!table) return 1;
+
+    long long list_sum = 0, table_sum = 0;
+
+    started = spotify_monotonic_ms();
+    for (int i = 0; i < BENCH_SCANS; i++) list_sum += scan_list(&list);
+    long long list_scan_ms = spotify_monotonic_ms() - started;
+
+    started = spotify_monotonic_ms();
+    for (int i = 0; i < BENCH_SCANS; i++) table_sum += scan_table(table);
+    long long table_scan_ms = spotify_monotonic_ms() - started;
+
+    // Both layouts must describe the same tracks
+    int mismatches = list_sum != table_sum;
+    for (int i = 0; i < count; i++) {
+        SpotifyTrack track;
+        spotify_track_table_get(table, i, &track);
+        const SpotifyTrack *expected = &list.tracks[i];
+        if (strcmp(track.id, expected->id) || strcmp(track.name, expected->name) ||
+            strcmp(track.artist, expected->artist) || strcmp(track.album, expected->album) ||
+            strcmp(track.uri, expected->uri) || track.duration_ms != expected->duration_ms) {
+            mismatches++;
+        }
+    }
+
+    size_t list_bytes = (size_t)count * sizeof(SpotifyTrack);
+    size_t table_bytes = spotify_track_table_memory(table);
+
+    printf("tracks: %d (%d artists, %d albums)\n", count, BENCH_ARTISTS,
+           BENCH_ARTISTS * BENCH_ALBUMS_PER_ARTIST);
+    printf("memory: list %.1f MiB, table %.1f MiB (%.1fx smaller)\n",
+           list_bytes / 1048576.0, table_bytes / 1048576.0,
+           table_bytes ? (double)list_bytes / table_bytes : 0.0);
+    printf("build:  table %lld ms\n", build_ms);
+    printf("scan:   list %lld ms, table %lld ms (%d passes)\n", list_scan_ms, table_scan_ms, BENCH_SCANS);
+    if (mismatches) printf("MISMATCH: %d rows differ\n", mismatches);
+
+    spotify_track_table_free(table);
+    free(list.tracks);
+    return mismatches ? 1 : 0;
+}